@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+// プレイヤーの操作（キーボードでもBotでも同じものを使う）
+// Simulation・MoveGenerator・入力処理・リプレイが共通で使うので、ゲームのルール本体とは別のヘッダにしておく
+enum class Action : std::uint8_t {
+    None,
+    MoveLeft,       // 左に1マス
+    MoveRight,      // 右に1マス
+    SoftDrop,       // 下に1マス
+    HardDrop,       // 一番下まで落として固定
+    RotateCW,       // 右回転
+    RotateCCW,      // 左回転
+    Hold,           // ホールド
+    MoveUp          // 上に1マス（デバッグ用）
+};
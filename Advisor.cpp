@@ -0,0 +1,234 @@
+#include "Advisor.hpp"
+#include "Piece.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+    const float DEAD = -1e9f;                // 置くとゲームオーバーになる（盤面より上にはみ出す）
+    const int MAX_DEPTH = 1 + Simulation::NEXT_COUNT;
+}
+
+// ==== 深さを決めた先読み ====
+// 1つの盤面を make / unmake で進めたり戻したりしながら深さ優先で調べる。時間切れか、新しいスナップショットが来たら打ち切る
+struct PlacementAdvisor::Search {
+    const std::atomic<std::uint64_t>& latest;
+    std::uint64_t generation;
+    std::chrono::steady_clock::time_point deadline;
+    const EvalWeights& weights;
+    std::array<PieceType, MAX_DEPTH> pieces;
+    int pieceCount = 0;
+
+    MoveGenerator gen;
+    // 深さごとの置き方の一覧（再帰の中で使い回す。PlacementAdvisor が持っているものを借りる）
+    std::vector<std::array<Placement, MoveGenerator::MAX_PLACEMENTS>>& lists;
+    std::uint64_t nodes = 0;
+    bool cancelled = false;
+
+    Search(const std::atomic<std::uint64_t>& latest, std::uint64_t generation,
+           std::chrono::steady_clock::time_point deadline, const EvalWeights& weights,
+           std::vector<std::array<Placement, MoveGenerator::MAX_PLACEMENTS>>& lists)
+        : latest(latest), generation(generation), deadline(deadline), weights(weights), lists(lists) {}
+
+    // 256局面ごとに、中止するかどうかを調べる
+    bool checkCancel() {
+        if ((++nodes & 255) == 0 &&
+            (latest.load(std::memory_order_relaxed) != generation || std::chrono::steady_clock::now() >= deadline))
+            cancelled = true;
+        return cancelled;
+    }
+
+    // type のピースを置いたときの盤面を作り、消したライン数を返す（盤面より上にはみ出したら -1）
+    static int apply(Board& board, PieceType type, const Placement& p) {
+        if (p.y + orientationOf(type, p.rotation).minY < 0) return -1;
+        Piece piece(type);
+        piece.rotation = p.rotation;
+        piece.x = p.x;
+        piece.y = p.y;
+        return Board::countLines(piece.placeAndClear(board));
+    }
+
+    // (hold, index) の状態から、あと depth 個置いたときの最善の評価値
+    // board は make / unmake で子局面に進めて戻すので、呼び出しの前後で同じ盤面になる
+    float best(Board& board, std::optional<PieceType> hold, int index, int depth, int level) {
+        if (depth == 0 || index >= pieceCount) return evaluate(board, weights);
+        if (checkCancel()) return DEAD;
+
+        float bestValue = DEAD;
+        auto tryPiece = [&](PieceType type, std::optional<PieceType> nextHold, int nextIndex) {
+            Placement* list = lists[level].data();
+            int n = gen.generate(board, type, list);
+            // 次が末端なら盤面を変えずに、置いたときの特徴だけを差分で求める
+            bool leaf = depth == 1 || nextIndex >= pieceCount;
+            for (int i = 0; i < n && !cancelled; ++i) {
+                const Orientation& o = orientationOf(type, list[i].rotation);
+                if (list[i].y + o.minY < 0) continue; // 盤面より上にはみ出す
+                float value;
+                if (leaf) {
+                    int lines = 0;
+                    FieldFeatures f = board.featuresAfter(o, list[i].x, list[i].y, &lines);
+                    value = weights.lines * lines + scoreFeatures(f, weights);
+                }
+                else {
+                    Board::UndoRecord undo;
+                    int lines = Board::countLines(board.make(type, list[i].rotation, list[i].x, list[i].y, undo));
+                    value = weights.lines * lines + best(board, nextHold, nextIndex, depth - 1, level + 1);
+                    board.unmake(undo);
+                }
+                bestValue = std::max(bestValue, value);
+            }
+        };
+        tryPiece(pieces[index], hold, index + 1);
+        if (hold) {
+            if (*hold != pieces[index]) tryPiece(*hold, pieces[index], index + 1);
+        }
+        else if (index + 1 < pieceCount) {
+            tryPiece(pieces[index + 1], pieces[index], index + 2);
+        }
+        return bestValue;
+    }
+};
+
+// ==================== PlacementAdvisor クラス ====================
+// 計算に使う配列は最初に確保しておき、ピースごとに確保し直さない
+PlacementAdvisor::PlacementAdvisor(int budgetMilliseconds) : budget(budgetMilliseconds), searchLists(MAX_DEPTH + 1) {
+    worker = std::thread(&PlacementAdvisor::run, this);
+}
+
+PlacementAdvisor::~PlacementAdvisor() {
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        stopping = true;
+    }
+    latestGeneration.fetch_add(1, std::memory_order_release); // 計算中なら中止させる
+    requestReady.notify_one();
+    worker.join();
+}
+
+// スナップショットを取って計算スレッドに渡す（コピーするだけなので描画スレッドはすぐ戻る）
+std::uint64_t PlacementAdvisor::submit(const Simulation& sim) {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    request.board = sim.board();
+    request.current = sim.current().type;
+    request.hold = sim.hold();
+    request.holdUsed = sim.holdUsed();
+    request.nextCount = std::min(sim.next().size(), Simulation::NEXT_COUNT);
+    for (int i = 0; i < request.nextCount; ++i) request.next[i] = sim.next()[i];
+    request.generation = latestGeneration.fetch_add(1, std::memory_order_acq_rel) + 1;
+    requestReady.notify_one();
+    return request.generation;
+}
+
+// 計算スレッド：新しいスナップショットを待って計算する、を繰り返す
+void PlacementAdvisor::run() {
+    std::uint64_t done = 0;
+    for (;;) {
+        Snapshot snap;
+        {
+            std::unique_lock<std::mutex> lock(requestMutex);
+            requestReady.wait(lock, [&] { return stopping || request.generation != done; });
+            if (stopping) return;
+            snap = request;
+            done = snap.generation;
+        }
+        analyze(snap);
+    }
+}
+
+// 低い段数から順に、データベースに載っているかを調べる（ネクストが長い問題ほど先に見る）
+// 盤面が height 段より高い・ピースが足りないなどでキーにできない組み合わせは lookup がすぐ false を返す
+bool PlacementAdvisor::lookupPc(const Snapshot& snap) {
+    if (!pcDatabase || !pcDatabase->isOpen() || snap.holdUsed) return false;
+    PcProblem& problem = pcProblem;
+    problem.field = snap.board;
+    problem.current = snap.current;
+    problem.hold = snap.hold;
+    for (problem.height = 1; problem.height <= PcDatabase::MAX_HEIGHT; ++problem.height) {
+        for (int count = snap.nextCount; count >= 0; --count) {
+            problem.queue.assign(snap.next.begin(), snap.next.begin() + count);
+            PcDbAnswer& answer = pcAnswer;
+            if (!pcDatabase->lookup(problem, answer) || !answer.solvable || answer.solution.empty()) continue;
+
+            AdvisorResult result;
+            result.generation = snap.generation;
+            result.depth = static_cast<int>(answer.solution.size()); // パフェまで読み切っている
+            result.count = 1;
+            result.suggestions[0].placement = answer.solution[0];
+            result.suggestions[0].score = weights.lines * problem.height;
+            publish(result);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 深さ1から順に読み、深さが1つ終わるたびに結果を公開する
+void PlacementAdvisor::analyze(const Snapshot& snap) {
+    if (lookupPc(snap)) return;
+
+    Search search(latestGeneration, snap.generation,
+                  std::chrono::steady_clock::now() + std::chrono::milliseconds(budget), weights, searchLists);
+    search.pieces[0] = snap.current;
+    for (int i = 0; i < snap.nextCount; ++i) search.pieces[1 + i] = snap.next[i];
+    search.pieceCount = 1 + snap.nextCount;
+
+    // 最初の1手の候補（ホールドを使う置き方も含める）
+    firsts.clear();
+    std::array<Placement, MoveGenerator::MAX_PLACEMENTS> list;
+    auto addFirsts = [&](PieceType type, bool usedHold, std::optional<PieceType> nextHold, int nextIndex) {
+        int n = search.gen.generate(snap.board, type, list.data());
+        for (int i = 0; i < n; ++i) {
+            FirstMove m{ { list[i], DEAD }, snap.board, 0, nextHold, nextIndex };
+            m.suggestion.placement.hold = usedHold;
+            m.lines = Search::apply(m.board, type, list[i]);
+            if (m.lines >= 0) firsts.push_back(m);
+        }
+    };
+    addFirsts(snap.current, false, snap.hold, 1);
+    if (!snap.holdUsed) {
+        if (snap.hold) {
+            if (*snap.hold != snap.current) addFirsts(*snap.hold, true, snap.current, 1);
+        }
+        else if (snap.nextCount > 0) {
+            addFirsts(snap.next[0], true, snap.current, 2);
+        }
+    }
+
+    for (int depth = 1; depth <= search.pieceCount; ++depth) {
+        for (FirstMove& m : firsts) {
+            float value = search.best(m.board, m.hold, m.index, depth - 1, 0);
+            if (search.cancelled) break;
+            m.suggestion.score = search.weights.lines * m.lines + value;
+        }
+        // 途中で打ち切った深さの結果は使わない（1つ前の深さの結果が公開されたまま残る）
+        if (search.cancelled) return;
+
+        AdvisorResult result;
+        result.generation = snap.generation;
+        result.depth = depth;
+        // 上位 MAX_SUGGESTIONS 個だけを挿入して並べる（同点なら先の候補が上。std::stable_sort は作業用のメモリを確保するので使わない）
+        for (const FirstMove& m : firsts) {
+            int pos = result.count;
+            while (pos > 0 && m.suggestion.score > result.suggestions[pos - 1].score) --pos;
+            if (pos >= AdvisorResult::MAX_SUGGESTIONS) continue;
+            if (result.count < AdvisorResult::MAX_SUGGESTIONS) ++result.count;
+            for (int i = result.count - 1; i > pos; --i) result.suggestions[i] = result.suggestions[i - 1];
+            result.suggestions[pos] = m.suggestion;
+        }
+        publish(result);
+    }
+}
+
+// 書いた結果を middle と交換して公開する
+void PlacementAdvisor::publish(const AdvisorResult& result) {
+    slots[back] = result;
+    back = middle.exchange(static_cast<std::uint8_t>(back | NEW_BIT), std::memory_order_acq_rel) & 3;
+}
+
+// 新しい結果があれば middle と交換してから読む
+const AdvisorResult& PlacementAdvisor::read() {
+    if (middle.load(std::memory_order_relaxed) & NEW_BIT)
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+    return slots[front];
+}
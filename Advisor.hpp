@@ -0,0 +1,110 @@
+#pragma once
+#include "Board.hpp"
+#include "Eval.hpp"
+#include "MoveGen.hpp"
+#include "PcDatabase.hpp"
+#include "Simulation.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// ==== 置き場所のおすすめ（オーバーレイ表示用） ====
+// ピースが出るたびに盤面・ピース・ホールド・ネクストのコピー（スナップショット）を受け取り、
+// 別スレッドで「どこに置くと良いか」を順位つきで計算する
+// ・先読みを1手、2手、3手…と深くしていき、深さが1つ終わるたびに結果を公開する（時間の許す限り良くなる）
+// ・次のピースのスナップショットが来たら、前のピースの計算は途中でやめる
+// ・パフェのデータベース（PcDatabase）があり、今の状態が載っていれば、先読みの代わりにその手順の1手目を返す
+// ・結果はトリプルバッファ（ロックを使わない、読む側が待たないダブルバッファ）で渡すので、描画は止まらない
+
+// おすすめの置き方1つ
+struct Suggestion {
+    Placement placement;                     // 置き方（hold = true ならホールドしてから置く）
+    float score = 0.f;                       // 評価値（大きいほど良い）
+};
+
+// 公開される計算結果
+struct AdvisorResult {
+    static const int MAX_SUGGESTIONS = 3;
+
+    std::uint64_t generation = 0;            // どのスナップショットに対する結果か（Advisor::submit の戻り値）
+    int depth = 0;                           // 何手先まで読んだ結果か（0ならまだ結果なし）
+    int count = 0;                           // suggestions の有効な数
+    std::array<Suggestion, MAX_SUGGESTIONS> suggestions;
+};
+
+class PlacementAdvisor {
+public:
+    // budgetMilliseconds：1つのピースにかける計算時間の上限
+    explicit PlacementAdvisor(int budgetMilliseconds = 300);
+    ~PlacementAdvisor();
+    PlacementAdvisor(const PlacementAdvisor&) = delete;
+    PlacementAdvisor& operator=(const PlacementAdvisor&) = delete;
+
+    // 今の状態のスナップショットを渡して計算を始める（前の計算は中止される）。番号を返す
+    std::uint64_t submit(const Simulation& sim);
+    // 最後に渡したスナップショットの番号
+    std::uint64_t generation() const { return latestGeneration.load(std::memory_order_acquire); }
+
+    // 公開されている最新の結果（描画スレッドから呼ぶ。待つことはない）
+    // 返した参照は、次に read を呼ぶまで書き換えられない
+    const AdvisorResult& read();
+
+    EvalWeights weights;                     // 評価の重み（submit の前に変えること）
+    const PcDatabase* pcDatabase = nullptr;  // パフェのデータベース（なければ nullptr。submit の前に設定すること）
+
+private:
+    // 計算に使うスナップショット
+    struct Snapshot {
+        Board board;
+        PieceType current = PieceType::T;
+        std::optional<PieceType> hold;
+        bool holdUsed = false;
+        std::array<PieceType, Simulation::NEXT_COUNT> next{};
+        int nextCount = 0;
+        std::uint64_t generation = 0;
+    };
+
+    int budget;
+    std::thread worker;
+    std::mutex requestMutex;
+    std::condition_variable requestReady;
+    Snapshot request;                        // 最後に受け取ったスナップショット（requestMutex で守る）
+    bool stopping = false;
+    std::atomic<std::uint64_t> latestGeneration{ 0 };
+
+    // ---- トリプルバッファ ----
+    // 書く側（計算スレッド）と読む側（描画スレッド）がそれぞれ1つずつ持ち、残りの1つを middle として交換する
+    // middle の NEW_BIT は「まだ読まれていない新しい結果がある」印
+    static const std::uint8_t NEW_BIT = 4;
+    std::array<AdvisorResult, 3> slots;
+    std::atomic<std::uint8_t> middle{ 1 };
+    std::uint8_t back = 0;                   // 計算スレッドが書いている場所
+    std::uint8_t front = 2;                  // 描画スレッドが読んでいる場所
+
+    // ---- 計算スレッドが使い回す配列（ピースごとにメモリを確保し直さない） ----
+    // 最初の1手の候補
+    struct FirstMove {
+        Suggestion suggestion;
+        Board board;
+        int lines;
+        std::optional<PieceType> hold;
+        int index;
+    };
+    std::vector<FirstMove> firsts;
+    std::vector<std::array<Placement, MoveGenerator::MAX_PLACEMENTS>> searchLists; // 先読みの深さごとの置き方の一覧
+    PcProblem pcProblem;                     // データベースを引くときのキーと答え
+    PcDbAnswer pcAnswer;
+
+    void run();                              // 計算スレッドの本体
+    void analyze(const Snapshot& snap);      // 1つのスナップショットについて深さを増やしながら計算する
+    bool lookupPc(const Snapshot& snap);     // データベースにパフェの手順があれば、その1手目を公開して true を返す
+    void publish(const AdvisorResult& result);
+
+    // 探索（cancelled になったら途中で打ち切る）
+    struct Search;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// ==== ヒープ確保の回数を数える ====
+// AllocCounter.cpp を一緒にビルドすると、operator new / delete を置き換えて、new・std::vector・std::string などが
+// メモリを確保した回数を数える（スレッドごとの回数と、全スレッドの合計）
+// ゲーム中に確保を繰り返すと、長く遊んだときにメモリが断片化してフレームの時間がばらつくので、
+// 起動して一通り動いたあとは、1フレーム・1ピースで1回も確保しないことを確かめるのに使う
+// （Game は main.cpp の --alloc で終了時に表示、Headless は alloc モードで確保したら失敗にする）
+namespace heap {
+    std::uint64_t threadAllocations();       // このスレッドで確保した回数
+    std::uint64_t allocations();             // 全スレッドで確保した回数
+
+    // 区切り（1フレーム・1ピースなど）ごとの確保の回数をまとめる
+    struct Tally {
+        std::uint64_t windows = 0;           // 数えた区切りの数
+        std::uint64_t allocating = 0;        // 1回以上確保した区切りの数
+        std::uint64_t count = 0;             // 確保の回数の合計
+        std::uint64_t worst = 0;             // 1つの区切りで確保した回数の最大
+
+        void add(std::uint64_t allocationsInWindow) {
+            ++windows;
+            if (allocationsInWindow == 0) return;
+            ++allocating;
+            count += allocationsInWindow;
+            if (allocationsInWindow > worst) worst = allocationsInWindow;
+        }
+    };
+}
@@ -0,0 +1,162 @@
+#include "BagTracker.hpp"
+#include <algorithm>
+#include <bitset>
+
+namespace {
+int sizeOf(PieceSet set) { return static_cast<int>(std::bitset<8>(set).count()); }
+
+// 今の袋が空なら、次は新しい袋から出る
+void refill(PieceSet& pool, int& left) {
+    if (left > 0) return;
+    pool = ALL_PIECES;
+    left = BagTracker::BAG_SIZE;
+}
+
+// ホールドを使った置き方の探索（active = 次に手元に来るピースの位置、held = 持っているピース）
+void holdSearch(const std::vector<PieceType>& seq, int active, PieceType held, PieceSequence& prefix,
+                std::vector<PieceSequence>& out) {
+    if (active == static_cast<int>(seq.size())) {
+        out.push_back(prefix);
+        return;
+    }
+    PieceSequence saved = prefix;
+    // 来たピースをそのまま置く
+    prefix.push(seq[active]);
+    holdSearch(seq, active + 1, held, prefix, out);
+    prefix = saved;
+    // 持っているピースを置き、来たピースを持つ（同じ種類なら結果は同じなので1回だけ）
+    if (held != seq[active]) {
+        prefix.push(held);
+        holdSearch(seq, active + 1, seq[active], prefix, out);
+        prefix = saved;
+    }
+}
+}
+
+// ==================== BagTracker クラス ====================
+// 何も見ていなければ、今の袋から既に 0～6 個出ている（あと 7～1 個）のどれも同じくらいありうる
+// 既に出たものが何かは分からないので、どの候補でも7種類すべてを「まだ出ていないかもしれない」とする
+// （袋はランダムな並べ替えなので、前半を知らなければ残りは7種類からの重複なしの抜き出しと同じ確率になる）
+BagTracker::BagTracker() {
+    for (int i = 0; i < BAG_SIZE; ++i) candidates[i] = Candidate{ ALL_PIECES, BAG_SIZE - i, 1.0 / BAG_SIZE };
+    count = BAG_SIZE;
+}
+
+void BagTracker::knowRemaining(PieceSet remaining) {
+    remaining &= ALL_PIECES;
+    candidates[0] = Candidate{ remaining, sizeOf(remaining), 1.0 };
+    count = 1;
+}
+
+// 各候補で p が出る確率を掛け、出るはずのない候補を捨てる
+void BagTracker::observe(PieceType p) {
+    PieceSet bit = pieceBit(p);
+    double total = 0.0;
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        Candidate c = candidates[i];
+        refill(c.pool, c.left);
+        if (!(c.pool & bit)) continue;
+        c.weight /= sizeOf(c.pool);
+        c.pool &= static_cast<PieceSet>(~bit);
+        --c.left;
+        total += c.weight;
+        candidates[kept++] = c;
+    }
+    count = kept;
+    for (int i = 0; i < count; ++i) candidates[i].weight /= total;
+}
+
+void BagTracker::observe(const NextQueue& queue) {
+    for (int i = 0; i < queue.size(); ++i) observe(queue[i]);
+}
+
+int BagTracker::leftInBag() const {
+    return count == 1 ? candidates[0].left : -1;
+}
+
+std::vector<Continuation> BagTracker::continuations(int length) const {
+    std::vector<Continuation> out;
+    length = std::min(length, PieceSequence::MAX_LENGTH);
+    for (int i = 0; i < count; ++i) {
+        PieceSequence prefix;
+        enumerate(candidates[i].pool, candidates[i].left, candidates[i].weight, prefix, length, out);
+    }
+    // 候補が複数あると同じ並びが何度か出てくるので、まとめて確率を足す
+    std::sort(out.begin(), out.end(),
+              [](const Continuation& a, const Continuation& b) { return a.pieces < b.pieces; });
+    std::size_t merged = 0;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        if (merged > 0 && out[merged - 1].pieces == out[i].pieces) out[merged - 1].probability += out[i].probability;
+        else out[merged++] = out[i];
+    }
+    out.resize(merged);
+    return out;
+}
+
+void BagTracker::enumerate(PieceSet pool, int left, double probability, PieceSequence& prefix, int length,
+                           std::vector<Continuation>& out) const {
+    if (prefix.length == length) {
+        out.push_back(Continuation{ prefix, probability });
+        return;
+    }
+    refill(pool, left);
+    double each = probability / sizeOf(pool);
+    PieceSequence saved = prefix;
+    for (int t = 0; t < BAG_SIZE; ++t) {
+        PieceSet bit = static_cast<PieceSet>(1u << t);
+        if (!(pool & bit)) continue;
+        prefix.push(static_cast<PieceType>(t));
+        enumerate(static_cast<PieceSet>(pool & ~bit), left - 1, each, prefix, length, out);
+        prefix = saved;
+    }
+}
+
+// 並びは列挙せず、(残りの種類, あと何個) の状態の集合だけを1個ずつ進める（状態は 128×8 通りしかない）
+void BagTracker::possiblePieces(PieceSet* out, int length) const {
+    std::bitset<128 * 8> states;
+    for (int i = 0; i < count; ++i) states.set(candidates[i].pool * 8 + candidates[i].left);
+    for (int k = 0; k < length; ++k) {
+        std::bitset<128 * 8> nextStates;
+        PieceSet possible = 0;
+        for (int s = 0; s < 128 * 8; ++s) {
+            if (!states[s]) continue;
+            PieceSet pool = static_cast<PieceSet>(s / 8);
+            int left = s % 8;
+            refill(pool, left);
+            possible |= pool;
+            for (int t = 0; t < BAG_SIZE; ++t)
+                if (pool & (1u << t)) nextStates.set((pool & ~(1u << t)) * 8 + left - 1);
+        }
+        out[k] = possible;
+        states = nextStates;
+    }
+}
+
+BagTracker bagTrackerOf(const Simulation& sim) {
+    const Bag& bag = sim.currentBag();
+    PieceSet remaining = 0;
+    for (int t = 0; t < BagTracker::BAG_SIZE; ++t)
+        if (bag.remains(static_cast<PieceType>(t))) remaining |= static_cast<PieceSet>(1u << t);
+    BagTracker tracker;
+    tracker.knowRemaining(remaining);
+    return tracker;
+}
+
+// ==== ホールドを使って置ける順番 ====
+std::vector<PieceSequence> holdOrders(PieceType current, std::optional<PieceType> hold,
+                                      const PieceType* queue, int queueCount) {
+    // ホールドが空なら、今のピースを持った状態でネクストの先頭が来たのと同じ
+    std::vector<PieceType> seq;
+    if (hold) seq.push_back(current);
+    seq.insert(seq.end(), queue, queue + queueCount);
+    PieceType held = hold ? *hold : current;
+    if (static_cast<int>(seq.size()) > PieceSequence::MAX_LENGTH) seq.resize(PieceSequence::MAX_LENGTH);
+
+    std::vector<PieceSequence> out;
+    PieceSequence prefix;
+    holdSearch(seq, 0, held, prefix, out);
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
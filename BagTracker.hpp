@@ -0,0 +1,96 @@
+#pragma once
+#include "PieceTable.hpp"
+#include "Simulation.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// ==== 7種1巡の袋から、ネクストの先に来るピースを絞り込む ====
+// Bag は7種類を1つずつシャッフルして出すので、袋の中の何個目かが分かれば、その先に来うる並びは
+// 7^k 通りよりずっと少ない（袋の残りが r 個なら、最初の r 個はその r 種類の並べ替えだけ）
+// BagTracker は出てきたピースを順に見て、袋の中の位置と残りの種類を追いかける
+// ・最初から見ていれば（knowRemaining で袋の切れ目を教えれば）位置は1通りに決まる
+// ・途中から見始めたときは、位置の候補（最大7通り）をそれぞれ追い、同じ種類が2回出て矛盾した候補を捨てる
+//   （候補の確からしさは、その候補でそのピースが出る確率を掛けていく＝ベイズの更新）
+// ネクストより先は、来うる並びを確率つきで列挙するか（continuations）、位置ごとに来うる種類だけを求める（possiblePieces）
+// holdOrders は、ホールドを使って置ける順番（最大 2^n 通り、重複なし）を列挙する
+
+// ピースの種類の集合（ビット t が PieceType t）
+using PieceSet = std::uint8_t;
+const PieceSet ALL_PIECES = 0x7F;
+inline PieceSet pieceBit(PieceType t) { return static_cast<PieceSet>(1u << static_cast<int>(t)); }
+
+// ピースの並び。1個3ビットずつ下から詰める（21個まで）
+// 比較は bits と length だけなので、ソートして重複を除ける
+struct PieceSequence {
+    static const int MAX_LENGTH = 21;
+    std::uint64_t bits = 0;
+    int length = 0;
+
+    PieceType at(int i) const { return static_cast<PieceType>((bits >> (3 * i)) & 7); }
+    void push(PieceType p) {
+        bits |= static_cast<std::uint64_t>(p) << (3 * length);
+        ++length;
+    }
+    bool operator==(const PieceSequence& other) const { return bits == other.bits && length == other.length; }
+    bool operator<(const PieceSequence& other) const {
+        return length != other.length ? length < other.length : bits < other.bits;
+    }
+};
+
+// 見えているピースの後ろに続きうる並びと、その確率
+struct Continuation {
+    PieceSequence pieces;
+    double probability = 0.0;
+};
+
+// ==================== BagTracker クラス ====================
+class BagTracker {
+public:
+    static const int BAG_SIZE = 7;
+
+    BagTracker();                            // 袋の中の位置が分からない状態から始める
+
+    // 次に出るピースまでで、今の袋に残っている種類が分かっている（ALL_PIECES なら次が新しい袋の最初）
+    void knowRemaining(PieceSet remaining);
+    // 出てきたピースを1つ、出てきた順に見る
+    void observe(PieceType p);
+    void observe(const NextQueue& queue);    // Nextの先頭から順に observe する
+
+    // 見たピースが7種1巡で説明できるか（false なら7種1巡ではない。予想は何も返さない）
+    bool consistent() const { return count > 0; }
+    int candidateCount() const { return count; } // 袋の中の位置の候補の数
+    // 今の袋からあと何個出るか（位置が1通りに決まっていなければ -1）
+    int leftInBag() const;
+
+    // 見たピースの後ろに続きうる length 個の並びを、確率つきで全部返す（並びの順にソート済み）
+    // 数は最大で 7!（length = 7）程度。length は PieceSequence::MAX_LENGTH まで
+    std::vector<Continuation> continuations(int length) const;
+    // 見たピースの後ろ i 個目（0から）に来うる種類を out[i] に書く（length 個。メモリは確保しない）
+    void possiblePieces(PieceSet* out, int length) const;
+
+private:
+    // 袋の中の位置の候補
+    struct Candidate {
+        PieceSet pool;                       // 今の袋からまだ出ていない（かもしれない）種類
+        int left;                            // 今の袋からあと何個出るか（0なら次は新しい袋）
+        double weight;                       // 確からしさ（合計が1）
+    };
+    // 位置の候補は left が7で割った余りごとに1つなので、7個までで足りる
+    std::array<Candidate, BAG_SIZE> candidates{};
+    int count = 0;
+
+    void enumerate(PieceSet pool, int left, double probability, PieceSequence& prefix, int length,
+                   std::vector<Continuation>& out) const;
+};
+
+// Simulation のネクストの後ろについて、袋の位置が確定した BagTracker を作る
+BagTracker bagTrackerOf(const Simulation& sim);
+
+// ==== ホールドを使って置ける順番 ====
+// current（今のピース）・hold・queue（ネクスト）から、ホールドに1つ残るまで置いたときの置く順番を、重複なしで全部返す
+// ホールドが空なら queueCount 個、入っていれば queueCount + 1 個を置く。数は最大で 2^(置く数) 通り
+// （ホールドは「手元の2つのうちどちらかを置き、残りを持っておく」のと同じなので、各ピースで2択になる）
+std::vector<PieceSequence> holdOrders(PieceType current, std::optional<PieceType> hold,
+                                      const PieceType* queue, int queueCount);
@@ -0,0 +1,711 @@
+// ==== ベンチマーク用のプログラム ====
+// 盤面・ピースの基本操作（マイクロベンチマーク）と、
+// 決まった盤面での手生成・perft・パフェ探索（マクロベンチマーク）の速さを測り、結果を JSON で出力する
+// リリースごとに結果を残しておけば、遅くなった変更を見つけられる
+// SFMLには依存しない
+//
+// 使い方: Bench [パフェ探索のスレッド数（0ならコア数）] > bench.json
+#include "BagTracker.hpp"
+#include "Board.hpp"
+#include "Collision.hpp"
+#include "Eval.hpp"
+#include "MoveGen.hpp"
+#include "Piece.hpp"
+#include "Solver.hpp"
+#include "TranspositionTable.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+    // 計算結果をここに足し込んで、最適化で処理ごと消されないようにする
+    volatile std::uint64_t sink = 0;
+
+    // 1つの計測にかける最低時間（秒）
+    const double MIN_SECONDS = 0.2;
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // body(n) で n 回の操作を行い、MIN_SECONDS を超えるまで回数を倍にしていく
+    // 1回あたりのナノ秒を返し、最後に回した回数を ops に入れる
+    template <class F>
+    double nsPerOp(F body, long long& ops) {
+        long long n = 1024;
+        for (;;) {
+            auto start = std::chrono::steady_clock::now();
+            body(n);
+            double seconds = secondsSince(start);
+            if (seconds >= MIN_SECONDS) {
+                ops = n;
+                return seconds * 1e9 / static_cast<double>(n);
+            }
+            n *= 2;
+        }
+    }
+
+    // プロセスが使ったメモリの最大値（KB）
+    long long peakMemoryKb() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+        return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+        return static_cast<long long>(usage.ru_maxrss / 1024); // macOS はバイト単位
+#else
+        return static_cast<long long>(usage.ru_maxrss);        // Linux は KB 単位
+#endif
+#endif
+    }
+
+    // ==== 計測に使う盤面 ====
+    // 文字列は上の行から順に書き、盤面の一番下にそろえて置く（'#' = ブロック、'.' = 空き）
+    struct FieldSpec {
+        const char* name;
+        std::vector<const char*> rows;
+    };
+
+    Board makeBoard(const FieldSpec& spec) {
+        Board board;
+        int top = Board::HEIGHT - static_cast<int>(spec.rows.size());
+        for (int r = 0; r < static_cast<int>(spec.rows.size()); ++r)
+            for (int x = 0; x < Board::WIDTH; ++x)
+                if (spec.rows[r][x] == '#') board.placeBlock(x, top + r, 1);
+        return board;
+    }
+
+    const std::vector<FieldSpec> FIELDS = {
+        { "empty", {} },
+        { "tsd", {
+            "##........",
+            "#........#",
+            "###.######",
+            "####.#####" } },
+        { "jagged", {
+            "....#.....",
+            "#..###...#",
+            "##.####.##",
+            "####.#####",
+            "#######.##",
+            "##.#######" } },
+        { "overhang", {
+            "...#######",
+            "..........",
+            "##.....###",
+            "###...####",
+            "####.#####",
+            "#####.####",
+            "######.###",
+            "#######.##",
+            "########.#" } },
+    };
+
+    // ==== パフェ探索の問題 ====
+    struct SolverSpec {
+        const char* name;
+        FieldSpec field;
+        int height;
+        std::vector<PieceType> pieces;      // 先頭が現在のピース、残りがネクスト
+    };
+
+    const std::vector<SolverSpec> SOLVER_CASES = {
+        { "2line-empty", { "empty", {} }, 2,
+          { PieceType::I, PieceType::O, PieceType::I, PieceType::O, PieceType::L, PieceType::J } },
+        { "4line-left6", { "left6", {
+            "######....",
+            "######....",
+            "######....",
+            "######...." } }, 4,
+          { PieceType::I, PieceType::O, PieceType::T, PieceType::L, PieceType::J, PieceType::S, PieceType::Z } },
+        { "4line-left4", { "left4", {
+            "####......",
+            "####......",
+            "####......",
+            "####......" } }, 4,
+          { PieceType::T, PieceType::I, PieceType::L, PieceType::J, PieceType::S, PieceType::O, PieceType::Z } },
+    };
+
+    // ==== perft（空の盤面から順に置いたときの末端の局面数。手生成の正しさの確認も兼ねる） ====
+    struct PerftSpec {
+        int depth;
+        std::uint64_t expected;
+    };
+    const PieceType PERFT_QUEUE[] = { PieceType::T, PieceType::I, PieceType::O, PieceType::L };
+    const std::vector<PerftSpec> PERFT_CASES = { { 1, 34 }, { 2, 596 }, { 3, 5573 }, { 4, 200411 } };
+
+    // ==== 手生成の答え合わせ用の、素直な幅優先探索 ====
+    // MoveGenerator とは別に、ゲームと同じ Piece::canMove / Piece::tryRotate だけで状態 (x, y, 回転) をたどり、
+    // 着地できる状態の埋めるマスの集合を返す（遅いが、ビット演算や範囲の制限・空の行の省略をしていない）
+    using CellSet = std::array<int, 4>;     // 埋めるマスの番号（y * WIDTH + x）を小さい順に並べたもの
+
+    CellSet cellsOf(const Piece& piece) {
+        CellSet cells;
+        std::array<Cell, 4> positions = piece.getAbsolutePositions();
+        for (int i = 0; i < 4; ++i) cells[i] = positions[i].y * Board::WIDTH + positions[i].x;
+        std::sort(cells.begin(), cells.end());
+        return cells;
+    }
+
+    std::set<CellSet> referencePlacements(const Board& board, PieceType type) {
+        std::set<CellSet> landed;
+        Piece spawn(type);
+        spawn.x = MoveGenerator::SPAWN_X;
+        spawn.y = MoveGenerator::SPAWN_Y;
+        if (!spawn.canMove(board, 0, 0)) return landed;
+
+        std::set<std::array<int, 3>> seen;
+        std::vector<Piece> queue{ spawn };
+        seen.insert({ spawn.x, spawn.y, static_cast<int>(spawn.rotation) });
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const Piece piece = queue[head];
+            if (!piece.canMove(board, 0, 1)) landed.insert(cellsOf(piece));
+
+            Piece next[5] = { piece, piece, piece, piece, piece };
+            bool ok[5] = {
+                piece.canMove(board, -1, 0), piece.canMove(board, 1, 0), piece.canMove(board, 0, 1),
+                next[3].tryRotate(board, true), next[4].tryRotate(board, false) };
+            next[0].move(-1, 0);
+            next[1].move(1, 0);
+            next[2].move(0, 1);
+            for (int i = 0; i < 5; ++i)
+                if (ok[i] && seen.insert({ next[i].x, next[i].y, static_cast<int>(next[i].rotation) }).second)
+                    queue.push_back(next[i]);
+        }
+        return landed;
+    }
+
+    // MoveGenerator::generate の結果を同じ形にする（同じマスの置き方が2回出ていれば数が合わなくなる）
+    std::set<CellSet> generatedPlacements(MoveGenerator& gen, const Board& board, PieceType type, int& count) {
+        static Placement list[MoveGenerator::MAX_PLACEMENTS];
+        count = gen.generate(board, type, list);
+        std::set<CellSet> cells;
+        for (int i = 0; i < count; ++i) {
+            Piece piece(type);
+            piece.rotation = list[i].rotation;
+            piece.x = list[i].x;
+            piece.y = list[i].y;
+            cells.insert(cellsOf(piece));
+        }
+        return cells;
+    }
+
+    // 答え合わせ用の perft（盤面をコピーしてマスを1つずつ置き、全部の行を調べて消す。make / unmake は使わない）
+    std::uint64_t referencePerft(const Board& board, const PieceType* queue, int depth) {
+        if (depth == 0) return 1;
+        std::set<CellSet> placements = referencePlacements(board, queue[0]);
+        if (depth == 1) return placements.size();
+        std::uint64_t total = 0;
+        for (const CellSet& cells : placements) {
+            Board child = board;
+            for (int c : cells) child.placeBlock(c % Board::WIDTH, c / Board::WIDTH, 1);
+            child.clearLines();
+            total += referencePerft(child, queue + 1, depth - 1);
+        }
+        return total;
+    }
+
+    // 凸凹・穴・ひさしのある盤面をランダムに作る（上の4行は空けて、出現位置には置けるようにする）
+    Board randomBoard(std::mt19937& rng) {
+        Board board;
+        std::uniform_int_distribution<int> heightOf(0, Board::HEIGHT - 4);
+        std::uniform_int_distribution<int> percent(0, 99);
+        int holePercent = percent(rng) / 4;
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            int height = heightOf(rng) * percent(rng) / 100;
+            for (int y = Board::HEIGHT - height; y < Board::HEIGHT; ++y)
+                if (percent(rng) >= holePercent) board.placeBlock(x, y, 1);
+        }
+        // 隣の列の上にかぶさるひさし
+        for (int i = percent(rng) % 4; i > 0; --i) {
+            int x = percent(rng) % Board::WIDTH;
+            int y = 4 + percent(rng) % (Board::HEIGHT - 4);
+            board.placeBlock(x, y, 1);
+        }
+        return board;
+    }
+
+    // ==== JSON出力 ====
+    // 計測結果を1件ずつ "{...}" の文字列にしてためておき、最後に配列として書き出す
+    std::vector<std::string> records;
+
+    void addRecord(const char* fmt, ...) {
+        char buffer[512];
+        va_list args;
+        va_start(args, fmt);
+        std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+        va_end(args);
+        records.push_back(buffer);
+    }
+}
+
+// ==================== マイクロベンチマーク ====================
+static void benchMicro() {
+    Board field = makeBoard(FIELDS[2]);
+    long long ops = 0;
+    double ns;
+
+    // --- Board::isOccupied（盤面の外側1マスも含めて順に調べる） ---
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            int x = static_cast<int>(i % 12) - 1;
+            int y = static_cast<int>((i / 12) % 22) - 1;
+            sum += field.isOccupied(x, y);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board::isOccupied\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- Piece::canMove（7種類・4回転で左右と下を調べる） ---
+    ns = nsPerOp([&](long long n) {
+        static const int DX[3] = { -1, 1, 0 };
+        static const int DY[3] = { 0, 0, 1 };
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            Piece piece(static_cast<PieceType>(i % 7));
+            piece.rotation = static_cast<Rotation>((i / 7) % 4);
+            piece.x = static_cast<int>((i / 28) % 8);
+            piece.y = 12;
+            sum += piece.canMove(field, DX[i % 3], DY[i % 3]);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Piece::canMove\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- Piece::rotate（トレースは trace::start していないので記録されない） ---
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        Piece piece(PieceType::T);
+        for (long long i = 0; i < n; ++i) {
+            if ((i & 63) == 0) piece = Piece(static_cast<PieceType>((i >> 6) % 7));
+            sum += piece.rotate(field, (i & 1) == 0 || (i & 2) == 0);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Piece::rotate\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- Board::clearLines（4段そろった盤面をコピーして消す。コピーの時間も含む） ---
+    Board full = makeBoard(FIELDS[3]);
+    for (int y = Board::HEIGHT - 4; y < Board::HEIGHT; ++y)
+        for (int x = 0; x < Board::WIDTH; x += 2) full.placeBlock(x, y, 1);
+    for (int y = Board::HEIGHT - 4; y < Board::HEIGHT; ++y)
+        for (int x = 1; x < Board::WIDTH; x += 2) full.placeBlock(x, y, 2);
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            Board board = full;
+            sum += board.clearLines();
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board::clearLines\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- Board::clearLines(top, bottom)（同じ盤面で、そろった4行だけを範囲として渡す） ---
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            Board board = full;
+            sum += board.clearLines(Board::HEIGHT - 4, Board::HEIGHT - 1);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board::clearLines(top,bottom)\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- 同じ4行を、パフェ探索の盤面（PcSolver::PcField、64ビット1つ）で消す ---
+    const PcSolver::PcField packed = bottomRowsOf<PcSolver::PcField>(full);
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            PcSolver::PcField f = packed;
+            sum += f.clearLines() + f.bits;
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"PcField::clearLines\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- そろう行がないとき（ほとんどの固定はこちら）：全部の行を調べる場合と、ミノがかかった行だけ調べる場合 ---
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) sum += field.clearLines();
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board::clearLines/none\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            int top = static_cast<int>(i % (Board::HEIGHT - 3));
+            sum += field.clearLines(top, top + 2);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board::clearLines(top,bottom)/none\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- Bag::getNext ---
+    Bag bag;
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) sum += static_cast<int>(bag.getNext());
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Bag::getNext\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- ネクストの先の予想：袋の2個目まで見えているとき、次の7個になりうる並び（7^7 = 823543 通りより少ない） ---
+    BagTracker tracker;
+    tracker.knowRemaining(ALL_PIECES);
+    tracker.observe(PieceType::T);
+    tracker.observe(PieceType::I);
+    std::size_t sequences = 0;
+    ns = nsPerOp([&](long long n) {
+        for (long long i = 0; i < n; ++i) sequences = tracker.continuations(7).size();
+        sink = sink + sequences;
+    }, ops);
+    addRecord("{\"name\":\"BagTracker::continuations(7)\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f,\"sequences\":%zu}",
+              ops, ns, sequences);
+    const PieceType queue[Simulation::NEXT_COUNT] = { PieceType::S, PieceType::Z, PieceType::I, PieceType::O, PieceType::L };
+    std::size_t orders = 0;
+    ns = nsPerOp([&](long long n) {
+        for (long long i = 0; i < n; ++i) orders = holdOrders(PieceType::T, PieceType::J, queue, Simulation::NEXT_COUNT).size();
+        sink = sink + orders;
+    }, ops);
+    addRecord("{\"name\":\"holdOrders\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f,\"orders\":%zu}", ops, ns, orders);
+
+    // --- 置いたときの特徴：盤面全体から数える（computeFeatures）と、差分で求める（Board::featuresAfter） ---
+    static Placement moves[MoveGenerator::MAX_PLACEMENTS];
+    MoveGenerator gen;
+    int moveCount = gen.generate(field, PieceType::T, moves);
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            const Placement& p = moves[i % moveCount];
+            Board child = field;
+            Piece piece(p.type);
+            piece.rotation = p.rotation;
+            piece.x = p.x;
+            piece.y = p.y;
+            piece.placeAndClear(child);
+            sum += static_cast<std::uint64_t>(computeFeatures(child).holes);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"computeFeatures(place+copy)\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            const Placement& p = moves[i % moveCount];
+            sum += static_cast<std::uint64_t>(field.featuresAfter(orientationOf(p.type, p.rotation), p.x, p.y).holes);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board::featuresAfter\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- 子局面の作り方：盤面をコピーして置く場合と、make / unmake で進めて戻す場合 ---
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            const Placement& p = moves[i % moveCount];
+            Board child = field;
+            Piece piece(p.type);
+            piece.rotation = p.rotation;
+            piece.x = p.x;
+            piece.y = p.y;
+            sum += piece.placeAndClear(child) + child.hash;
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board copy+placeAndClear\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+    ns = nsPerOp([&](long long n) {
+        std::uint64_t sum = 0;
+        Board work = field;
+        Board::UndoRecord undo;
+        for (long long i = 0; i < n; ++i) {
+            const Placement& p = moves[i % moveCount];
+            sum += work.make(p.type, p.rotation, p.x, p.y, undo) + work.hash;
+            work.unmake(undo);
+        }
+        sink = sink + sum;
+    }, ops);
+    addRecord("{\"name\":\"Board::make+unmake\",\"kind\":\"micro\",\"ops\":%lld,\"ns_per_op\":%.3f}", ops, ns);
+
+    // --- CollisionField::fitColumns（この CPU で使える計算方法ごとに、7種類・4回転の置ける位置を求める） ---
+    CollisionField collision(field);
+    for (int b = 0; b < 3; ++b) {
+        CollisionField::Backend backend = static_cast<CollisionField::Backend>(b);
+        if (!CollisionField::supported(backend)) continue;
+        ns = nsPerOp([&](long long n) {
+            std::uint64_t sum = 0;
+            CollisionField::Columns columns;
+            for (long long i = 0; i < n; ++i) {
+                collision.fitColumns(orientationOf(static_cast<PieceType>(i % 7), static_cast<Rotation>((i / 7) % 4)),
+                                     columns, backend);
+                sum += columns[5];
+            }
+            sink = sink + sum;
+        }, ops);
+        addRecord("{\"name\":\"CollisionField::fitColumns\",\"kind\":\"micro\",\"backend\":\"%s\",\"ops\":%lld,\"ns_per_op\":%.3f}",
+                  CollisionField::nameOf(backend), ops, ns);
+    }
+}
+
+// ==================== マクロベンチマーク ====================
+// 手生成：盤面ごとに7種類すべてを列挙する
+static void benchMoveGen() {
+    MoveGenerator gen;
+    static Placement list[MoveGenerator::MAX_PLACEMENTS];
+    for (const FieldSpec& spec : FIELDS) {
+        Board board = makeBoard(spec);
+        int placements = 0;
+        for (int t = 0; t < 7; ++t) placements += gen.generate(board, static_cast<PieceType>(t), list);
+
+        long long ops = 0;
+        double ns = nsPerOp([&](long long n) {
+            std::uint64_t sum = 0;
+            for (long long i = 0; i < n; ++i) sum += gen.generate(board, static_cast<PieceType>(i % 7), list);
+            sink = sink + sum;
+        }, ops);
+        addRecord("{\"name\":\"movegen/%s\",\"kind\":\"movegen\",\"ops\":%lld,\"ns_per_op\":%.3f,\"placements\":%d}",
+                  spec.name, ops, ns, placements);
+    }
+}
+
+// perft：決まった局面数になるかも確認する（"ok":false なら手生成が壊れている）
+static bool benchPerft() {
+    bool allOk = true;
+    for (const PerftSpec& spec : PERFT_CASES) {
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t count = perft(Board(), PERFT_QUEUE, spec.depth);
+        double seconds = secondsSince(start);
+        bool ok = count == spec.expected;
+        allOk = allOk && ok;
+        addRecord("{\"name\":\"perft/%d\",\"kind\":\"perft\",\"depth\":%d,\"count\":%llu,\"expected\":%llu,"
+                  "\"ok\":%s,\"ms\":%.3f,\"nodes_per_sec\":%.0f}",
+                  spec.depth, spec.depth, static_cast<unsigned long long>(count),
+                  static_cast<unsigned long long>(spec.expected), ok ? "true" : "false",
+                  seconds * 1e3, static_cast<double>(count) / seconds);
+    }
+    return allOk;
+}
+
+// 手生成の答え合わせ：ランダムな盤面で、MoveGenerator::generate と素直な幅優先探索の置き方が一致するか
+// perft の期待値も、答え合わせ用の探索で数え直して確かめる（期待値が手生成そのものから作った値なので）
+static bool benchMoveGenReference() {
+    const int BOARDS = 500;
+    const int REFERENCE_PERFT_DEPTH = 3;
+    MoveGenerator gen;
+    std::mt19937 rng(12345);
+    int mismatches = 0, duplicates = 0;
+    long long placements = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < BOARDS; ++b) {
+        Board board = randomBoard(rng);
+        for (int t = 0; t < 7; ++t) {
+            PieceType type = static_cast<PieceType>(t);
+            int count = 0;
+            std::set<CellSet> generated = generatedPlacements(gen, board, type, count);
+            std::set<CellSet> expected = referencePlacements(board, type);
+            placements += count;
+            if (static_cast<std::size_t>(count) != generated.size()) ++duplicates;
+            if (generated != expected) ++mismatches;
+        }
+    }
+    double seconds = secondsSince(start);
+    bool boardsOk = mismatches == 0 && duplicates == 0;
+    addRecord("{\"name\":\"movegen/reference\",\"kind\":\"check\",\"boards\":%d,\"placements\":%lld,"
+              "\"mismatches\":%d,\"duplicates\":%d,\"ok\":%s,\"ms\":%.3f}",
+              BOARDS, placements, mismatches, duplicates, boardsOk ? "true" : "false", seconds * 1e3);
+
+    bool perftOk = true;
+    for (const PerftSpec& spec : PERFT_CASES) {
+        if (spec.depth > REFERENCE_PERFT_DEPTH) break;
+        std::uint64_t count = referencePerft(Board(), PERFT_QUEUE, spec.depth);
+        bool ok = count == spec.expected;
+        perftOk = perftOk && ok;
+        addRecord("{\"name\":\"perft/%d/reference\",\"kind\":\"check\",\"count\":%llu,\"expected\":%llu,\"ok\":%s}",
+                  spec.depth, static_cast<unsigned long long>(count), static_cast<unsigned long long>(spec.expected),
+                  ok ? "true" : "false");
+    }
+    return boardsOk && perftOk;
+}
+
+// 当たり判定の答え合わせ：この CPU で使える計算方法ごとに、CollisionField::fitColumns の結果が
+// すべての (x, y) で Board::fits と一致するか（盤面は手生成の答え合わせと同じものと、上の行まで埋まったでたらめなもの）
+static bool benchCollisionBackends() {
+    const int BOARDS = 500;
+    std::mt19937 rng(54321);
+    std::vector<Board> boards;
+    for (int b = 0; b < BOARDS; ++b) {
+        if (b % 2 == 0) {
+            boards.push_back(randomBoard(rng));
+            continue;
+        }
+        Board noise;
+        for (int y = 0; y < Board::HEIGHT; ++y)
+            for (int x = 0; x < Board::WIDTH; ++x)
+                if (rng() % 100 < 30) noise.placeBlock(x, y, 1);
+        boards.push_back(noise);
+    }
+
+    bool allOk = true;
+    for (int b = 0; b < 3; ++b) {
+        CollisionField::Backend backend = static_cast<CollisionField::Backend>(b);
+        if (!CollisionField::supported(backend)) continue;
+        long long positions = 0, mismatches = 0;
+        for (const Board& board : boards) {
+            CollisionField field(board);
+            for (int t = 0; t < 7; ++t)
+                for (int r = 0; r < 4; ++r) {
+                    const Orientation& o = orientationOf(static_cast<PieceType>(t), static_cast<Rotation>(r));
+                    CollisionField::Columns columns;
+                    field.fitColumns(o, columns, backend);
+                    for (int x = -CollisionField::X_OFFSET; x < CollisionField::X_RANGE - CollisionField::X_OFFSET; ++x)
+                        for (int y = -CollisionField::Y_OFFSET; y < CollisionField::Y_RANGE - CollisionField::Y_OFFSET; ++y) {
+                            bool fits = (columns[x + CollisionField::X_OFFSET] >> (y + CollisionField::Y_OFFSET)) & 1u;
+                            ++positions;
+                            if (fits != board.fits(o, x, y)) ++mismatches;
+                        }
+                }
+        }
+        bool ok = mismatches == 0;
+        allOk = allOk && ok;
+        addRecord("{\"name\":\"CollisionField::fitColumns/reference\",\"kind\":\"check\",\"backend\":\"%s\","
+                  "\"boards\":%d,\"positions\":%lld,\"mismatches\":%lld,\"ok\":%s}",
+                  CollisionField::nameOf(backend), BOARDS, positions, mismatches, ok ? "true" : "false");
+    }
+    return allOk;
+}
+
+// パフェ探索：最初の手順が見つかるまでの時間と、全部列挙し終わるまでの時間・手順の数
+static void benchSolver(unsigned threads) {
+    PcSolver solver(threads);
+    for (const SolverSpec& spec : SOLVER_CASES) {
+        PcProblem problem;
+        problem.field = makeBoard(spec.field);
+        problem.height = spec.height;
+        problem.current = spec.pieces.front();
+        problem.queue.assign(spec.pieces.begin() + 1, spec.pieces.end());
+
+        // 前の問題の置換表の内容で速くならないように、毎回空にする
+        solver.transpositionTable().clear();
+        auto start = std::chrono::steady_clock::now();
+        std::size_t solutions = solver.solve(problem).size();
+        double seconds = secondsSince(start);
+        std::uint64_t nodes = solver.nodeCount();
+
+        addRecord("{\"name\":\"solver/%s\",\"kind\":\"solver\",\"threads\":%u,\"solutions\":%zu,\"nodes\":%llu,"
+                  "\"first_solution_ms\":%.3f,\"total_ms\":%.3f,\"nodes_per_sec\":%.0f}",
+                  spec.name, solver.threadCount(), solutions, static_cast<unsigned long long>(nodes),
+                  solver.firstSolutionSeconds() * 1e3, seconds * 1e3, static_cast<double>(nodes) / seconds);
+    }
+}
+
+// 置換表の置き換え：Always でも、同じバケットの4スロットを使い回すか
+// （1バケットだけの表に、上位ビットが 0〜3 のキーを順に書いたとき、最後の4つがすべて残っていること）
+static bool benchTableReplacement() {
+    TranspositionTable table(0, ReplacePolicy::Always);
+    const int KEYS = 64;
+    std::uint64_t state = 1;
+    std::vector<std::uint64_t> keys;
+    for (int i = 0; i < KEYS; ++i) {
+        std::uint64_t key = (zobrist::splitmix64(state) & ~(3ull << 56)) | (static_cast<std::uint64_t>(i & 3) << 56);
+        keys.push_back(key);
+        TTEntry entry;
+        entry.value = static_cast<std::uint32_t>(i);
+        table.store(key, entry);
+    }
+    int found = 0;
+    for (int i = KEYS - 4; i < KEYS; ++i) {
+        TTEntry entry;
+        if (table.probe(keys[i], entry) && entry.value == static_cast<std::uint32_t>(i)) ++found;
+    }
+    bool ok = table.bucketCount() == 1 && found == 4;
+    addRecord("{\"name\":\"TranspositionTable::store/always\",\"kind\":\"check\",\"buckets\":%zu,\"kept\":%d,\"ok\":%s}",
+              table.bucketCount(), found, ok ? "true" : "false");
+    return ok;
+}
+
+// パフェ探索の置換表が問題をまたいで混ざらないか：同じ盤面・ネクストを段数を変えて同じ PcSolver で続けて解き、
+// 毎回新しく作った PcSolver の答えと比べる（段数がキーに入っていないと、4段で調べた「パフェにならない」が2段にも使われる）
+static bool benchSolverReuse(unsigned threads) {
+    // 4段ではパフェにならず（上の2段を I だけでは埋められない）、2段なら O でパフェになる
+    const FieldSpec field = { "right2", {
+        "########..",
+        "########.." } };
+    const std::vector<PieceType> pieces = { PieceType::O, PieceType::I, PieceType::I, PieceType::I, PieceType::I, PieceType::I };
+    const int HEIGHTS[] = { 4, 2, 4 };
+
+    auto same = [](const std::vector<Solution>& a, const std::vector<Solution>& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (a[i].size() != b[i].size()) return false;
+            for (std::size_t k = 0; k < a[i].size(); ++k) {
+                const Placement& p = a[i][k];
+                const Placement& q = b[i][k];
+                if (p.type != q.type || p.rotation != q.rotation || p.x != q.x || p.y != q.y || p.hold != q.hold) return false;
+            }
+        }
+        return true;
+    };
+
+    PcSolver reused(threads);
+    bool allOk = true;
+    for (int height : HEIGHTS) {
+        PcProblem problem;
+        problem.field = makeBoard(field);
+        problem.height = height;
+        problem.current = pieces.front();
+        problem.queue.assign(pieces.begin() + 1, pieces.end());
+
+        PcSolver fresh(threads);
+        std::vector<Solution> expected = fresh.solve(problem);
+        std::vector<Solution> got = reused.solve(problem);
+        bool ok = same(expected, got);
+        allOk = allOk && ok;
+        addRecord("{\"name\":\"solver/reuse/%s/h%d\",\"kind\":\"check\",\"expected\":%zu,\"solutions\":%zu,\"ok\":%s}",
+                  field.name, height, expected.size(), got.size(), ok ? "true" : "false");
+    }
+    return allOk;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 0u;
+
+    benchMicro();
+    benchMoveGen();
+    bool perftOk = benchPerft();
+    bool checksOk = benchMoveGenReference();
+    checksOk = benchCollisionBackends() && checksOk;
+    benchSolver(threads);
+    checksOk = benchTableReplacement() && checksOk;
+    checksOk = benchSolverReuse(threads) && checksOk;
+
+    std::printf("{\n  \"benchmarks\": [\n");
+    for (std::size_t i = 0; i < records.size(); ++i)
+        std::printf("    %s%s\n", records[i].c_str(), i + 1 < records.size() ? "," : "");
+    std::printf("  ],\n  \"perft_ok\": %s,\n  \"checks_ok\": %s,\n  \"peak_memory_kb\": %lld\n}\n",
+                perftOk ? "true" : "false", checksOk ? "true" : "false", peakMemoryKb());
+
+    // perft や手生成の答え合わせが合わなければ失敗として終了する（CIで検出できるように）
+    return perftOk && checksOk ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "Board.hpp"
+#include "PieceTable.hpp"
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+// ==== 大きさをコンパイル時に決める、ブロックの有無だけの盤面 ====
+// Board はゲーム用（10×20、色・特徴・ハッシュつき）。パフェの探索のように下の数段しか見ない処理では、
+// ブロックの有無だけをこのクラスで持つ
+// ・W×H が64以下なら、盤面全体を1つの64ビット整数に詰める（10×6 まで。コピー・比較・置く・消すがレジスタだけで済む）
+// ・それより大きければ、Board と同じく行ごとのビット列の配列で持つ
+// どちらも同じ使い方（row / fits / place / clearLines）ができる
+// 行 y は上から数える（Board と同じ向き）。1行はビット x が列 x
+
+template <int W, int H, bool Packed = (W * H <= 64)>
+class BitBoard;
+
+// ---- 64ビット1つに詰める版 ----
+// 行 y はビット y*W から W ビット
+template <int W, int H>
+class BitBoard<W, H, true> {
+public:
+    static_assert(W <= 16 && W * H <= 64, "packed BitBoard must fit in 64 bits");
+    static const int WIDTH = W;
+    static const int HEIGHT = H;
+    static constexpr std::uint64_t ROW_MASK = (1ull << W) - 1;
+
+    std::uint64_t bits = 0;
+
+    std::uint16_t row(int y) const { return static_cast<std::uint16_t>((bits >> (y * W)) & ROW_MASK); }
+    void setRow(int y, std::uint16_t value) {
+        bits = (bits & ~(ROW_MASK << (y * W))) | ((value & ROW_MASK) << (y * W));
+    }
+    bool empty() const { return bits == 0; }
+    int count() const { return static_cast<int>(std::bitset<64>(bits).count()); }
+    bool operator==(const BitBoard& other) const { return bits == other.bits; }
+
+    // 向き o のピースを (x, y) に置けるか（盤面の外にはみ出したら置けない）
+    bool fits(const Orientation& o, int x, int y) const {
+        std::uint64_t mask;
+        return maskOf(o, x, y, mask) && (bits & mask) == 0;
+    }
+    // ピースを置く（置けることを確かめてから呼ぶこと）
+    void place(const Orientation& o, int x, int y) {
+        std::uint64_t mask;
+        if (maskOf(o, x, y, mask)) bits |= mask;
+    }
+    // そろった行を消して上の行を詰める（消した行のビット列を返す。Board::clearLines と同じ形）
+    std::uint32_t clearLines() {
+        std::uint32_t cleared = 0;
+        std::uint64_t kept = 0;
+        int dst = H - 1;
+        for (int y = H - 1; y >= 0; --y) {
+            std::uint64_t r = (bits >> (y * W)) & ROW_MASK;
+            if (r == ROW_MASK) {
+                cleared |= 1u << y;
+                continue;
+            }
+            kept |= r << (dst * W);
+            --dst;
+        }
+        bits = kept;
+        return cleared;
+    }
+
+private:
+    // ピースが埋めるマスのビット列（盤面からはみ出すなら false）
+    static bool maskOf(const Orientation& o, int x, int y, std::uint64_t& mask) {
+        int left = x + o.minX, top = y + o.minY;
+        if (left < 0 || x + o.maxX >= W || top < 0 || y + o.maxY >= H) return false;
+        mask = 0;
+        for (int r = 0; r < o.height; ++r) mask |= static_cast<std::uint64_t>(o.rowMasks[r]) << ((top + r) * W + left);
+        return true;
+    }
+};
+
+// ---- 行ごとのビット列の配列で持つ版 ----
+template <int W, int H>
+class BitBoard<W, H, false> {
+public:
+    static_assert(W <= 16, "BitBoard rows are 16 bits wide");
+    static const int WIDTH = W;
+    static const int HEIGHT = H;
+    static constexpr std::uint16_t ROW_MASK = static_cast<std::uint16_t>((1u << W) - 1);
+
+    std::array<std::uint16_t, H> rows{};
+
+    std::uint16_t row(int y) const { return rows[y]; }
+    void setRow(int y, std::uint16_t value) { rows[y] = value & ROW_MASK; }
+    bool empty() const {
+        for (std::uint16_t r : rows)
+            if (r) return false;
+        return true;
+    }
+    int count() const {
+        int n = 0;
+        for (std::uint16_t r : rows) n += static_cast<int>(std::bitset<16>(r).count());
+        return n;
+    }
+    bool operator==(const BitBoard& other) const { return rows == other.rows; }
+
+    bool fits(const Orientation& o, int x, int y) const {
+        int left = x + o.minX, top = y + o.minY;
+        if (left < 0 || x + o.maxX >= W || top < 0 || y + o.maxY >= H) return false;
+        for (int r = 0; r < o.height; ++r)
+            if (rows[top + r] & (o.rowMasks[r] << left)) return false;
+        return true;
+    }
+    void place(const Orientation& o, int x, int y) {
+        if (!fits(o, x, y)) return;
+        int left = x + o.minX, top = y + o.minY;
+        for (int r = 0; r < o.height; ++r) rows[top + r] |= static_cast<std::uint16_t>(o.rowMasks[r] << left);
+    }
+    std::uint32_t clearLines() {
+        static_assert(H <= 32, "cleared rows are returned as 32 bits");
+        std::uint32_t cleared = 0;
+        int dst = H - 1;
+        for (int y = H - 1; y >= 0; --y) {
+            if (rows[y] == ROW_MASK) {
+                cleared |= 1u << y;
+                continue;
+            }
+            rows[dst--] = rows[y];
+        }
+        while (dst >= 0) rows[dst--] = 0;
+        return cleared;
+    }
+};
+
+// Board の下から H 段を取り出す（W は Board::WIDTH と同じであること）
+template <class Bits>
+Bits bottomRowsOf(const Board& board) {
+    static_assert(Bits::WIDTH == Board::WIDTH && Bits::HEIGHT <= Board::HEIGHT, "field must fit in Board");
+    Bits out;
+    for (int y = 0; y < Bits::HEIGHT; ++y) out.setRow(y, board.rows[Board::HEIGHT - Bits::HEIGHT + y]);
+    return out;
+}
@@ -1,72 +1,318 @@
 #include "Board.hpp" 
+#include <bitset>
+#include <cstdlib>
 #include <iostream>
 
-// Blockクラスのコンストラクタ
-Block::Block(bool f, sf::Color c) : filled(f), color(c) {}
+namespace {
+    // 1行の横方向の切り替わりの数（左右の壁はブロック扱い。ブロックのない行は数えない）
+    // 置くたびに2回ずつ数えるので、1行のビット列（1024通り）ごとの表にしておく
+    constexpr std::array<std::uint8_t, 1u << Board::WIDTH> buildTransitions() {
+        std::array<std::uint8_t, 1u << Board::WIDTH> table{};
+        for (std::uint32_t row = 1; row < (1u << Board::WIDTH); ++row) {
+            std::uint32_t walled = (row << 1) | 1u | (1u << (Board::WIDTH + 1));
+            std::uint32_t changes = (walled ^ (walled >> 1)) & ((1u << (Board::WIDTH + 1)) - 1);
+            int count = 0;
+            for (; changes != 0; changes &= changes - 1) ++count;
+            table[row] = static_cast<std::uint8_t>(count);
+        }
+        return table;
+    }
+    constexpr auto TRANSITIONS = buildTransitions();
 
-// ブロックを描画する
-void Block::draw(sf::RenderWindow& window, int x, int y, int size) {
-    // 枠付きで描画するため、1px 小さくしている
-    sf::RectangleShape rect(sf::Vector2f(size - 1, size - 1));
-    rect.setPosition(x, y);
-    rect.setFillColor(filled ? color : sf::Color(30, 30, 30)); // 空は濃いグレー
-    window.draw(rect);
+    inline int transitionsOf(std::uint16_t row) { return TRANSITIONS[row]; }
+
+    // 列 a と a + 1 の高さの差（盤面の外なら0）
+    inline int bumpAt(const FieldFeatures& f, int a) {
+        if (a < 0 || a + 1 >= Board::WIDTH) return 0;
+        return std::abs(f.heights[a] - f.heights[a + 1]);
+    }
+
+    // 列 x の井戸の深さ（両どなりの低いほうより、どれだけ低いか。壁は盤面の高さとする）
+    inline int wellAt(const FieldFeatures& f, int x) {
+        if (x < 0 || x >= Board::WIDTH) return 0;
+        int left = x > 0 ? f.heights[x - 1] : Board::HEIGHT;
+        int right = x + 1 < Board::WIDTH ? f.heights[x + 1] : Board::HEIGHT;
+        int rim = left < right ? left : right;
+        return rim > f.heights[x] ? rim - f.heights[x] : 0;
+    }
 }
 
 // Boardのコンストラクタ（空の20×10盤面を作る）
 Board::Board() {
-    grid.resize(HEIGHT, std::vector<Block>(WIDTH));
+    rows.fill(0);
+    for (auto& row : colors) row.fill(EMPTY);
 }
 
-// 盤面全体を描画
-void Board::draw(sf::RenderWindow& window) {
-    for (int y = 0; y < HEIGHT; ++y)
-        for (int x = 0; x < WIDTH; ++x)
-            grid[y][x].draw(window, x * 40, y * 40);
-}
+// 指定座標にブロックを配置する
+void Board::placeBlock(int x, int y, std::uint8_t color) {
+    if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
+        // 空きマスを埋めたときだけハッシュを更新する（色の上書きでは変わらない）
+        if (!((rows[y] >> x) & 1u)) {
+            hash ^= zobrist::cellKey(x, y);
+            std::uint16_t old = rows[y];
+            rows[y] |= static_cast<std::uint16_t>(1u << x);
 
-// 指定座標にブロックがあるかどうかを判定
-bool Board::isOccupied(int x, int y) {
-    // 横がはみ出したらtrue（移動できない）
-    if (x < 0 || x >= WIDTH || y >= HEIGHT) return true;
-    // 上側（y < 0）はまだ盤面外なのでfalse
-    if (y < 0) return false;
-    return grid[y][x].filled;
+            // 特徴の差分更新：この行の切り替わり、この列の高さ（高くなったときだけ）、穴
+            ++blockCount;
+            features.rowTransitions += transitionsOf(rows[y]) - transitionsOf(old);
+            int top = HEIGHT - y;
+            if (top > features.heights[x]) raiseColumns(features, x, x, &top);
+            features.holes = features.aggregateHeight - blockCount;
+        }
+        colors[y][x] = color;
+    }
 }
 
-// 指定座標にブロックを配置する
-void Board::placeBlock(int x, int y, sf::Color color) {
-    if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
-        grid[y][x].filled = true;
-        grid[y][x].color = color;
+// ミノを行ごとにまとめて置く（ハッシュ・行の切り替わりは行ごとに1回、高さは列ごとに更新する）
+void Board::placePiece(const Orientation& o, int x, int y, std::uint8_t color) {
+    int left = x + o.minX;
+    for (int r = 0; r < o.height; ++r) {
+        int row = y + o.minY + r;
+        if (row < 0 || row >= HEIGHT) continue;
+        std::uint16_t mask = static_cast<std::uint16_t>(o.rowMasks[r] << left);
+        std::uint16_t added = mask & static_cast<std::uint16_t>(~rows[row]); // 既に埋まっているマスは色だけ上書き
+        if (added) {
+            hash ^= zobrist::rowKey(row, added);
+            blockCount += static_cast<int>(std::bitset<16>(added).count());
+            features.rowTransitions += transitionsOf(rows[row] | added) - transitionsOf(rows[row]);
+            rows[row] |= added;
+        }
+        for (std::uint16_t bits = o.rowMasks[r], cx = 0; bits != 0; ++cx, bits >>= 1)
+            if (bits & 1u) colors[row][left + cx] = color;
     }
+    raiseColumns(features, o, x, y);
+    features.holes = features.aggregateHeight - blockCount;
 }
 
-// 揃ったラインを削除し、削除した行数を返す
+// 揃ったラインを削除し、削除した行数を返す（どの行がそろったか分からないときは全部の行を調べる）
 int Board::clearLines() {
     //関数が呼び出されているかの確認
     //std::cout << "[DEBUG] clearLines() called\n";
-    int linesCleared = 0;
-    for (int y = HEIGHT - 1; y >= 0; --y) {
-        //ライン消去デバッグ
-        //std::cout << "Row " << y << ": "<<std::endl;
-        bool full = true;
-        // 1行がすべて埋まっているか確認
-        for (int x = 0; x < WIDTH; ++x)
-            if (!grid[y][x].filled) full = false;
-
-        if (full) {
-            ++linesCleared;
-            // 該当行を上から1つずつ落とす
-            for (int row = y; row > 0; --row)
-                for (int x = 0; x < WIDTH; ++x)
-                    grid[row][x] = grid[row - 1][x];
-            // 一番上の行を空にする
-            for (int x = 0; x < WIDTH; ++x)
-                grid[0][x] = Block(false, sf::Color::Black);
-            // 同じyを再チェック（連続消去対応）
-            ++y;
+    return countLines(clearLines(0, HEIGHT - 1));
+}
+
+// 行 top～bottom のうち、そろった行を消す
+// 消えるのは置いたミノがかかった行だけなので、調べるのは最大4行。そろった行がなければ何も動かさない
+// 消すときは、bottom から上へ1回の走査で残る行を詰める（bottom より下の行は動かない）
+std::uint32_t Board::clearLines(int top, int bottom) {
+    if (top < 0) top = 0;
+    if (bottom >= HEIGHT) bottom = HEIGHT - 1;
+    std::uint32_t cleared = 0;
+    for (int y = top; y <= bottom; ++y)
+        // 1行がすべて埋まっているかはビット列の比較1回で分かる
+        if (rows[y] == FULL_ROW) cleared |= 1u << y;
+    if (cleared == 0) return 0;
+
+    // スタックより上の行は空なので、詰めるのはスタックの一番上の行まででよい
+    int stackTop = HEIGHT - features.maxHeight;
+    int dst = bottom;
+    for (int y = bottom; y >= stackTop; --y) {
+        if ((cleared >> y) & 1u) continue;
+        if (dst != y) {
+            // 書き換わる行だけ、古い行と新しい行の XOR 値を入れ替える
+            hash ^= zobrist::rowKey(dst, rows[dst]) ^ zobrist::rowKey(dst, rows[y]);
+            rows[dst] = rows[y];
+            colors[dst] = colors[y];
+        }
+        --dst;
+    }
+    // 空いた上側の行を空にする
+    for (; dst >= stackTop; --dst) {
+        hash ^= zobrist::rowKey(dst, rows[dst]);
+        rows[dst] = 0;
+        colors[dst].fill(EMPTY);
+    }
+    // そろった行の切り替わりは0なので、行の切り替わりの合計は変わらない。高さだけ数え直す
+    blockCount -= countLines(cleared) * WIDTH;
+    recountHeights(features, rows, blockCount);
+    return cleared;
+}
+
+// ガベージのせり上がり
+bool Board::addGarbage(int lines, int hole) {
+    if (lines <= 0) return true;
+    if (lines > HEIGHT) lines = HEIGHT;
+    bool overflow = false;
+    for (int y = 0; y < lines; ++y)
+        if (rows[y] != 0) overflow = true;
+
+    for (int y = 0; y + lines < HEIGHT; ++y) {
+        rows[y] = rows[y + lines];
+        colors[y] = colors[y + lines];
+    }
+    const std::uint16_t garbage = static_cast<std::uint16_t>(FULL_ROW & ~(1u << hole));
+    for (int y = HEIGHT - lines; y < HEIGHT; ++y) {
+        rows[y] = garbage;
+        colors[y].fill(static_cast<std::uint8_t>(GARBAGE)); // fill は参照で受け取るので値にして渡す
+        colors[y][hole] = EMPTY;
+    }
+
+    hash = computeHash();
+    blockCount = 0;
+    features.rowTransitions = 0;
+    for (int y = 0; y < HEIGHT; ++y) {
+        blockCount += static_cast<int>(std::bitset<16>(rows[y]).count());
+        if (rows[y] != 0) features.rowTransitions += transitionsOf(rows[y]);
+    }
+    recountHeights(features, rows, blockCount);
+    return !overflow;
+}
+
+// ==== make / unmake ====
+std::uint32_t Board::make(PieceType type, Rotation rotation, int x, int y, UndoRecord& undo) {
+    const Orientation& o = orientationOf(type, rotation);
+    undo.hash = hash;
+    undo.features = features;
+    undo.blockCount = blockCount;
+    undo.top = y + o.minY;
+
+    int left = x + o.minX;
+    for (int r = 0; r < 4; ++r) {
+        int row = undo.top + r;
+        bool inside = r < o.height && row >= 0 && row < HEIGHT;
+        undo.added[r] = inside ? static_cast<std::uint16_t>((o.rowMasks[r] << left) & ~rows[row]) : 0;
+    }
+    placePiece(o, x, y, static_cast<std::uint8_t>(1 + static_cast<int>(type)));
+
+    // 消える行の色は unmake で戻せるように覚えておく
+    undo.stackTop = HEIGHT - features.maxHeight;
+    for (int r = 0; r < o.height; ++r) {
+        int row = undo.top + r;
+        if (row >= 0 && row < HEIGHT && rows[row] == FULL_ROW) undo.clearedColors[r] = colors[row];
+    }
+    undo.cleared = clearLines(undo.top, undo.top + o.height - 1);
+    return undo.cleared;
+}
+
+void Board::unmake(const UndoRecord& undo) {
+    if (undo.cleared) {
+        // clearLines の逆：上の行から順に、消した行は元に戻し、それ以外は下にずれた行を元の位置に戻す
+        // 読む行（src）は書く行（y）より下にあり、まだ書き換えていない
+        int bottom = HEIGHT - 1;
+        while (!((undo.cleared >> bottom) & 1u)) --bottom;
+        int src = undo.stackTop + countLines(undo.cleared);
+        for (int y = undo.stackTop; y <= bottom; ++y) {
+            if ((undo.cleared >> y) & 1u) {
+                rows[y] = FULL_ROW;
+                colors[y] = undo.clearedColors[y - undo.top];
+            }
+            else {
+                rows[y] = rows[src];
+                colors[y] = colors[src];
+                ++src;
+            }
+        }
+    }
+    // 置いたマスを空に戻す
+    for (int r = 0; r < 4; ++r) {
+        std::uint16_t bits = undo.added[r];
+        if (!bits) continue;
+        int row = undo.top + r;
+        rows[row] &= static_cast<std::uint16_t>(~bits);
+        for (int x = 0; bits != 0; ++x, bits >>= 1)
+            if (bits & 1u) colors[row][x] = EMPTY;
+    }
+    hash = undo.hash;
+    features = undo.features;
+    blockCount = undo.blockCount;
+}
+
+// ==== 特徴の差分更新 ====
+void Board::raiseColumns(Features& f, int lo, int hi, const int* tops) {
+    // 高さが変わる列と、そのとなりの列の項だけを前後で数えて差を足す
+    int bumpBefore = 0, wellBefore = 0;
+    for (int a = lo - 1; a <= hi; ++a) bumpBefore += bumpAt(f, a);
+    for (int c = lo - 1; c <= hi + 1; ++c) wellBefore += wellAt(f, c);
+    for (int c = lo; c <= hi; ++c) {
+        int h = tops[c - lo];
+        if (h <= f.heights[c]) continue;
+        f.aggregateHeight += h - f.heights[c];
+        f.heights[c] = h;
+        if (h > f.maxHeight) f.maxHeight = h;
+    }
+    for (int a = lo - 1; a <= hi; ++a) f.bumpiness += bumpAt(f, a);
+    for (int c = lo - 1; c <= hi + 1; ++c) f.wellDepth += wellAt(f, c);
+    f.bumpiness -= bumpBefore;
+    f.wellDepth -= wellBefore;
+}
+
+void Board::raiseColumns(Features& f, const Orientation& o, int x, int y) {
+    int tops[4] = { 0, 0, 0, 0 };            // ミノの列ごとの一番上のマスの高さ（盤面より上のマスは置かれない）
+    bool raised = false;
+    for (const Cell& c : o.cells) {
+        int top = y + c.y >= 0 ? HEIGHT - (y + c.y) : 0;
+        int& t = tops[c.x - o.minX];
+        if (top > t) t = top;
+        raised = raised || top > f.heights[x + c.x];
+    }
+    if (raised) raiseColumns(f, x + o.minX, x + o.maxX, tops);
+}
+
+// 上の行から順に「ここより上にブロックがある列」のビット列を作り、初めて出てきた行をその列の高さにする
+void Board::recountHeights(Features& f, const std::array<std::uint16_t, HEIGHT>& rows, int blocks) {
+    f.heights.fill(0);
+    std::uint16_t covered = 0;
+    for (int y = 0; y < HEIGHT && covered != FULL_ROW; ++y) {
+        std::uint16_t newTops = rows[y] & static_cast<std::uint16_t>(~covered);
+        for (int x = 0; newTops != 0; ++x, newTops >>= 1)
+            if (newTops & 1u) f.heights[x] = HEIGHT - y;
+        covered |= rows[y];
+    }
+    f.aggregateHeight = f.maxHeight = f.bumpiness = f.wellDepth = 0;
+    for (int x = 0; x < WIDTH; ++x) {
+        f.aggregateHeight += f.heights[x];
+        if (f.heights[x] > f.maxHeight) f.maxHeight = f.heights[x];
+        f.bumpiness += bumpAt(f, x);
+        f.wellDepth += wellAt(f, x);
+    }
+    f.holes = f.aggregateHeight - blocks;
+}
+
+// 置いたつもりで特徴を求める（盤面は変えない）
+Board::Features Board::featuresAfter(const Orientation& o, int x, int y, int* lines) const {
+    Features f = features;
+    int left = x + o.minX;
+    int added = 0, full = 0;
+    std::array<std::uint16_t, 4> placed{};
+    for (int r = 0; r < o.height; ++r) {
+        int row = y + o.minY + r;
+        if (row < 0 || row >= HEIGHT) continue; // 盤面より上のマスは置かれない（placeBlock と同じ）
+        placed[r] = static_cast<std::uint16_t>(rows[row] | (o.rowMasks[r] << left));
+        added += static_cast<int>(std::bitset<16>(o.rowMasks[r]).count());
+        if (placed[r] == FULL_ROW) ++full;
+    }
+    if (lines) *lines = full;
+
+    if (full == 0) {
+        // ラインが消えなければ、ミノのかかる行の切り替わりと、ミノのかかる列の高さだけが変わる
+        for (int r = 0; r < o.height; ++r) {
+            int row = y + o.minY + r;
+            if (row >= 0 && row < HEIGHT) f.rowTransitions += transitionsOf(placed[r]) - transitionsOf(rows[row]);
         }
+        raiseColumns(f, o, x, y);
+        f.holes = f.aggregateHeight - (blockCount + added);
+        return f;
     }
-    return linesCleared;
+
+    // ラインが消えるときは、行のビット列だけをコピーして詰め、高さを数え直す
+    std::array<std::uint16_t, HEIGHT> after = rows;
+    for (int r = 0; r < o.height; ++r) {
+        int row = y + o.minY + r;
+        if (row < 0 || row >= HEIGHT) continue;
+        f.rowTransitions += transitionsOf(placed[r]) - transitionsOf(rows[row]); // そろった行は0
+        after[row] = placed[r];
+    }
+    int dst = HEIGHT - 1;
+    for (int yy = HEIGHT - 1; yy >= 0; --yy)
+        if (after[yy] != FULL_ROW) after[dst--] = after[yy];
+    for (; dst >= 0; --dst) after[dst] = 0;
+    recountHeights(f, after, blockCount + added - full * WIDTH);
+    return f;
+}
+
+// ハッシュを盤面全体から計算し直す
+std::uint64_t Board::computeHash() const {
+    std::uint64_t h = 0;
+    for (int y = 0; y < HEIGHT; ++y) h ^= zobrist::rowKey(y, rows[y]);
+    return h;
 }
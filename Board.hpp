@@ -1,41 +1,138 @@
 #pragma once 
-#include <vector> 
-#include <SFML/Graphics.hpp> 
-
-// 1マスを表すクラス
-class Block {
-public:
-    bool filled;          // ブロックが埋まっているかどうか
-    sf::Color color;      // ブロックの色
-
-    // コンストラクタ（デフォルトは空で黒色）
-    Block(bool f = false, sf::Color c = sf::Color::Black);
-
-    // ブロックを描画する
-    void draw(sf::RenderWindow& window, int x, int y, int size = 40);
-};
+#include <array> 
+#include <bitset>
+#include <cstdint> 
+#include "PieceTable.hpp"
+#include "Zobrist.hpp"
 
 // テトリスの盤面を表すクラス
+// 描画（SFML）には依存しないので、ウィンドウのないプログラムからも使える
+// 盤面の描画は Game 側（Game.cpp）で行う
 class Board {
 public:
     static const int WIDTH = 10;   // 横幅（列数）
     static const int HEIGHT = 20;  // 縦幅（行数）
+    static const std::uint16_t FULL_ROW = (1u << WIDTH) - 1; // 1行がすべて埋まった状態のビット列
+
+    // 盤面の特徴（評価関数が使う。FieldFeatures という名前でも使える）
+    struct Features {
+        std::array<int, WIDTH> heights{};    // 列ごとの高さ（一番上のブロックまで。空の列は0）
+        int aggregateHeight = 0;             // 列の高さの合計
+        int maxHeight = 0;                   // 一番高い列の高さ
+        int holes = 0;                       // 上をブロックでふさがれた空きマスの数
+        int bumpiness = 0;                   // となりの列との高さの差の合計（でこぼこ具合）
+        int wellDepth = 0;                   // 両どなり（または壁）より低い列の、低い分の合計（井戸の深さ）
+        int rowTransitions = 0;              // 横方向に「空き⇔ブロック」が切り替わる回数（左右の壁はブロック扱い）
+    };
 
-    // 盤面データ（高さ×幅の2次元配列）
-    std::vector<std::vector<Block>> grid;
+    // make で置いた1手を unmake で元に戻すための記録（盤面全体をコピーする代わりに、変わる部分だけ覚える）
+    struct UndoRecord {
+        std::uint64_t hash;                  // 置く前のハッシュ・特徴・ブロック数
+        Features features;
+        int blockCount;
+        int top;                             // ミノの一番上の行
+        int stackTop;                        // ライン消去の直前のスタックの一番上の行
+        std::uint32_t cleared;               // 消した行のビット列（clearLines と同じ）
+        std::array<std::uint16_t, 4> added;  // ミノの行ごとに、新しく埋めたマス
+        std::array<std::array<std::uint8_t, WIDTH>, 4> clearedColors; // 消した行の色（ミノの行ごと）
+    };
+
+    // 占有ビットボード（1行を uint16_t で表し、ビットx が列x に対応する）
+    // 当たり判定とライン消去はすべてこちらを正とする
+    std::array<std::uint16_t, HEIGHT> rows;
+
+    // 色プレーン（描画専用。当たり判定には使わない）
+    // 0 = 空、1～7 = そのマスを埋めたピースの種類 + 1（実際の色は描画側で決める）
+    static const std::uint8_t EMPTY = 0;
+    static const std::uint8_t GARBAGE = 15;  // 対戦でせり上がってきたガベージ（ピースの色とは別にする）
+    std::array<std::array<std::uint8_t, WIDTH>, HEIGHT> colors;
+
+    // 盤面の Zobrist ハッシュ（placeBlock と clearLines で差分更新する）
+    std::uint64_t hash = 0;
+
+    // 盤面の特徴（placeBlock と clearLines で差分更新する）
+    // ・ブロックを1つ置いても、変わるのはその列の高さと、となりの列との差・その行の切り替わりだけ
+    // ・穴の数は「列の高さの合計 - ブロックの数」で求まる（列の一番上より下の空きマスが穴なので）
+    Features features;
+    int blockCount = 0;                      // 盤面にあるブロックの数
 
     // コンストラクタ（空の盤面を作成）
     Board();
 
-    // 盤面を描画する
-    void draw(sf::RenderWindow& window);
-
     // 指定座標が埋まっているかどうかを判定
-    bool isOccupied(int x, int y);
+    bool isOccupied(int x, int y) const;
+
+    // 形状 o のミノを (x, y) に置けるかを行マスクでまとめて判定
+    bool fits(const Orientation& o, int x, int y) const;
 
     // 指定座標にブロックを配置する
-    void placeBlock(int x, int y, sf::Color color);
+    void placeBlock(int x, int y, std::uint8_t color);
+
+    // 形状 o のミノを (x, y) に置く（Piece::place が使う。placeBlock を4回呼ぶのと同じ結果を行ごとにまとめて行う）
+    // 左右の壁・床からはみ出さない位置であること。盤面より上のマスは置かれない
+    void placePiece(const Orientation& o, int x, int y, std::uint8_t color);
 
     // そろったラインを消去し、消した行数を返す
     int clearLines();
+    // 行 top～bottom（置いたミノがかかった行）だけを調べてそろったラインを消し、
+    // 消した行のビット列（ビット y = 消す前の行 y）を返す。得点計算や消える行の表示に使える
+    std::uint32_t clearLines(int top, int bottom);
+    // 消した行のビット列から、消した行数を求める
+    static int countLines(std::uint32_t cleared);
+
+    // 置き方を盤面に適用する（ライン消去も行う）。undo に元に戻すための記録を書き、消した行のビット列を返す
+    // 探索では、子局面ごとに盤面をコピーする代わりに make → 子局面を調べる → unmake とする
+    std::uint32_t make(PieceType type, Rotation rotation, int x, int y, UndoRecord& undo);
+    // make の直前の状態に戻す（行・色・ハッシュ・特徴すべて。make と逆の順番で呼ぶこと）
+    void unmake(const UndoRecord& undo);
+
+    // 形状 o のミノを (x, y) に置いたら（ライン消去も含めて）特徴がどうなるかを、盤面を変えずに求める
+    // 消えるラインがなければ、ミノがかかる列（最大4列）と行だけを見る。lines には消えるライン数を入れる
+    Features featuresAfter(const Orientation& o, int x, int y, int* lines = nullptr) const;
+
+    // 下から lines 段のガベージ（hole の列だけ空いた行）をせり上げる。上の行は押し上げられる
+    // 一番上からブロックがはみ出したら false（ゲームオーバー）。全部の行が動くので、ハッシュと特徴は数え直す
+    bool addGarbage(int lines, int hole);
+
+    // ハッシュを盤面全体から計算し直す（差分更新が正しいかの確認用）
+    std::uint64_t computeHash() const;
+
+private:
+    // 列 lo～hi の高さを、それぞれ tops[列 - lo] まで高くし（低くはしない）、高さの合計・でこぼこ・井戸を差分で直す
+    static void raiseColumns(Features& f, int lo, int hi, const int* tops);
+    // ミノを (x, y) に置いたときの列の高さの更新（raiseColumns をミノのかかる列でまとめて呼ぶ）
+    static void raiseColumns(Features& f, const Orientation& o, int x, int y);
+    // ライン消去のあと、残った行から高さを数え直す（blocks は消したあとのブロックの数。行の切り替わりは変えない）
+    static void recountHeights(Features& f, const std::array<std::uint16_t, HEIGHT>& rows, int blocks);
 };
+
+using FieldFeatures = Board::Features;
+
+inline int Board::countLines(std::uint32_t cleared) {
+    return static_cast<int>(std::bitset<HEIGHT>(cleared).count());
+}
+
+static_assert(zobrist::ROWS == Board::HEIGHT, "Zobrist table must cover every row");
+
+// 探索で何億回も呼ばれるため、ヘッダ内でインライン展開する
+inline bool Board::isOccupied(int x, int y) const {
+    // 横がはみ出したら・床より下ならtrue（移動できない）
+    // unsigned にキャストすると x < 0 と x >= WIDTH を1回の比較で判定できる
+    if (static_cast<unsigned>(x) >= static_cast<unsigned>(WIDTH) || y >= HEIGHT) return true;
+    // 上側（y < 0）はまだ盤面外なのでfalse
+    if (y < 0) return false;
+    return (rows[y] >> x) & 1u;
+}
+
+// 1行ずつ isOccupied を4回呼ぶ代わりに、行マスクのAND（最大4回）で判定する
+inline bool Board::fits(const Orientation& o, int x, int y) const {
+    int left = x + o.minX;
+    // 左右の壁・床からはみ出していないか
+    if (left < 0 || x + o.maxX >= WIDTH || y + o.maxY >= HEIGHT) return false;
+    for (int r = 0; r < o.height; ++r) {
+        int row = y + o.minY + r;
+        // 上側（row < 0）は盤面外なので空として扱う
+        if (row >= 0 && (rows[row] & (o.rowMasks[r] << left))) return false;
+    }
+    return true;
+}
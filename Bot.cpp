@@ -0,0 +1,180 @@
+#include "Bot.hpp"
+#include "Piece.hpp"
+#include <algorithm>
+
+std::uint32_t BotStats::latencyPercentile(double percent) const {
+    if (latencies.empty()) return 0;
+    std::vector<std::uint32_t> sorted(latencies);
+    std::size_t k = static_cast<std::size_t>(percent / 100.0 * (sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+// ==================== BeamBot クラス ====================
+BeamBot::BeamBot(int budgetMicroseconds) : budget(budgetMicroseconds) {
+    counters.latencies.reserve(BotStats::LATENCY_SAMPLES);
+}
+
+// 確保した latencies はそのまま使い回す
+void BeamBot::resetStats() {
+    std::vector<std::uint32_t> latencies;
+    latencies.swap(counters.latencies);
+    counters = BotStats();
+    latencies.clear();
+    counters.latencies.swap(latencies);
+}
+
+BotDecision BeamBot::decide(const Simulation& sim) {
+    std::array<PieceType, Simulation::NEXT_COUNT + 1> queue;
+    int queueCount = 0;
+    for (int i = 0; i < sim.next().size() && queueCount < Simulation::NEXT_COUNT; ++i) queue[queueCount++] = sim.next()[i];
+    // 来うる種類が1つだけなら、見えていなくても確定している
+    PieceSet following = 0;
+    bagTrackerOf(sim).possiblePieces(&following, 1);
+    for (int t = 0; t < BagTracker::BAG_SIZE; ++t)
+        if (following == pieceBit(static_cast<PieceType>(t))) queue[queueCount++] = static_cast<PieceType>(t);
+    return decide(sim.board(), sim.current().type, sim.hold(), sim.holdUsed(), queue.data(), queueCount);
+}
+
+// 時間の許す限り、幅を広げながらビームサーチを繰り返す
+BotDecision BeamBot::decide(const Board& board, PieceType current, std::optional<PieceType> hold, bool holdUsed,
+                            const PieceType* queue, int queueCount) {
+    auto start = std::chrono::steady_clock::now();
+    deadline = start + budget;
+    timeUp = false;
+    nodes = 0;
+
+    pieces[0] = current;
+    pieceCount = 1;
+    for (int i = 0; i < queueCount && pieceCount < static_cast<int>(pieces.size()); ++i) pieces[pieceCount++] = queue[i];
+    rootHoldUsed = holdUsed;
+
+    Node root;
+    root.board = board;
+    root.hold = hold;
+
+    BotDecision decision;
+    for (int width = initialWidth; ; width *= 2) {
+        Placement first{ PieceType::T, Rotation::Spawn, 0, 0 };
+        int depth = search(root, width, first);
+        // 幅を広げた読み直しが途中で終わり、前より浅いなら前の結果を使う
+        if (depth > 0 && depth >= decision.depth) {
+            decision.found = true;
+            decision.placement = first;
+            decision.depth = depth;
+            decision.width = width;
+        }
+        if (depth == 0 || timeUp || width >= maxWidth) break;
+    }
+
+    if (decision.found) {
+        decision.actionCount = gen.findPath(board, decision.placement, decision.actions.data());
+        if (decision.actionCount < 0) {
+            // 列挙した置き方なので必ず見つかるはずだが、念のためそのまま落とす
+            decision.actions[0] = Action::HardDrop;
+            decision.actionCount = 1;
+        }
+    }
+    decision.nodes = nodes;
+    decision.latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    ++counters.decisions;
+    counters.nodes += nodes;
+    counters.depthTotal += static_cast<std::uint64_t>(decision.depth);
+    counters.maxDepth = std::max(counters.maxDepth, decision.depth);
+    counters.seconds += decision.latency.count() / 1e6;
+    std::uint32_t latency = static_cast<std::uint32_t>(decision.latency.count());
+    if (counters.latencies.size() < BotStats::LATENCY_SAMPLES) counters.latencies.push_back(latency);
+    else counters.latencies[(counters.decisions - 1) % BotStats::LATENCY_SAMPLES] = latency;
+    return decision;
+}
+
+bool BeamBot::play(Simulation& sim) {
+    BotDecision decision = decide(sim);
+    if (!decision.found) return false;
+    for (int i = 0; i < decision.actionCount; ++i) sim.apply(decision.actions[i]);
+    return true;
+}
+
+// 深さごとに、候補を全部評価して良い順に width 個だけ盤面を作る
+// 時間切れになったら、その深さは捨てて1つ前の深さまでの結果を返す（深さ1だけは最後まで読む）
+int BeamBot::search(const Node& root, int width, Placement& best) {
+    beam.assign(1, root);
+    int depth = 0;
+    for (;;) {
+        candidates.clear();
+        for (int p = 0; p < static_cast<int>(beam.size()); ++p) {
+            const Node& node = beam[p];
+            if (node.index >= pieceCount) continue;
+            PieceType current = pieces[node.index];
+            expand(p, current, false, node.hold, node.index + 1, depth);
+            if (depth == 0 && rootHoldUsed) continue;
+            if (node.hold) {
+                if (*node.hold != current) expand(p, *node.hold, true, current, node.index + 1, depth);
+            }
+            else if (node.index + 1 < pieceCount) {
+                expand(p, pieces[node.index + 1], true, current, node.index + 2, depth);
+            }
+            if (depth > 0 && outOfBudget()) {
+                timeUp = true;
+                return depth;
+            }
+        }
+        if (candidates.empty()) return depth;
+
+        if (static_cast<int>(candidates.size()) > width) {
+            std::nth_element(candidates.begin(), candidates.begin() + width, candidates.end(),
+                             [](const Candidate& a, const Candidate& b) { return a.value > b.value; });
+            candidates.resize(width);
+        }
+
+        nextBeam.clear();
+        int bestIndex = 0;
+        for (const Candidate& c : candidates) {
+            nextBeam.push_back(beam[c.parent]);
+            Node& n = nextBeam.back();
+            Piece piece(c.placement.type);
+            piece.rotation = c.placement.rotation;
+            piece.x = c.placement.x;
+            piece.y = c.placement.y;
+            piece.placeAndClear(n.board);
+            n.hold = c.hold;
+            n.index = c.index;
+            n.reward = c.reward;
+            n.value = c.value;
+            if (depth == 0) n.first = c.placement;
+            if (n.value > nextBeam[bestIndex].value) bestIndex = static_cast<int>(nextBeam.size()) - 1;
+        }
+        beam.swap(nextBeam);
+        best = beam[bestIndex].first;
+        ++depth;
+        if (depth >= maxDepth) return depth;
+
+        if (outOfBudget()) {
+            timeUp = true;
+            return depth;
+        }
+    }
+}
+
+bool BeamBot::outOfBudget() const {
+    return (nodeBudget > 0 && nodes >= nodeBudget) || std::chrono::steady_clock::now() >= deadline;
+}
+
+// type のピースを beam[parent] に置く置き方を、盤面を変えずに評価して候補に加える
+void BeamBot::expand(int parent, PieceType type, bool usedHold, std::optional<PieceType> nextHold, int nextIndex, int depth) {
+    const Node& node = beam[parent];
+    int n = gen.generate(node.board, type, list.data());
+    for (int i = 0; i < n; ++i) {
+        const Orientation& o = orientationOf(type, list[i].rotation);
+        if (list[i].y + o.minY < 0) continue; // 盤面より上にはみ出す
+        int lines = 0;
+        FieldFeatures f = node.board.featuresAfter(o, list[i].x, list[i].y, &lines);
+        float reward = node.reward + weights.lines * lines;
+        Placement placement = list[i];
+        // ホールドを使ったかは1手目のものだけ意味がある（findPath が Hold を入れる）
+        placement.hold = depth == 0 && usedHold;
+        candidates.push_back(Candidate{ parent, placement, nextHold, nextIndex, reward, reward + scoreFeatures(f, weights) });
+    }
+    nodes += static_cast<std::uint64_t>(n);
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "BagTracker.hpp"
+#include "Board.hpp"
+#include "Eval.hpp"
+#include "MoveGen.hpp"
+#include "Simulation.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// ==== ビームサーチで遊ぶBot ====
+// 今のピース・ホールド・見えているネクストすべてを使って置き方を先読みし、一番良い1手目を
+// キーボードと同じ Action の列（MoveGenerator::findPath）にして Simulation に入れる
+// ・1手ずつ深くしながら、深さごとに評価値の良い局面を width 個だけ残して次へ進む（ビームサーチ）
+// ・最後まで読めて時間が余れば、幅を2倍にして最初から読み直す
+// ・1つのピースにかける時間（budget）を過ぎたら、そこまでで読めた一番深い結果の1手目を使う
+//   （一定の PPS = 1秒あたりのピース数 で遊ばせるときは、budget をピースの間隔より短くしておく）
+// ネクストの後ろの1個が袋の残りから1通りに決まるとき（袋の7個目）は、それも読む（BagTracker）
+// 評価はおすすめ表示（PlacementAdvisor）と同じ evaluate なので、おすすめの良し悪しを比べる基準にもなる
+
+// 1ピース分の判断
+struct BotDecision {
+    bool found = false;                      // 置ける場所が見つかったか（なければゲームオーバー）
+    Placement placement{ PieceType::T, Rotation::Spawn, 0, 0 }; // 置き方（hold = true ならホールドしてから置く）
+    std::array<Action, MoveGenerator::MAX_PATH> actions{}; // 置くための操作（最後は HardDrop）
+    int actionCount = 0;
+    int depth = 0;                           // 何手先まで読めたか
+    int width = 0;                           // そのときのビームの幅
+    std::uint64_t nodes = 0;                 // 評価した局面の数
+    std::chrono::microseconds latency{ 0 };  // 判断にかかった時間
+};
+
+// 判断の統計（Headless の bot モード・Game の --bot で表示する）
+struct BotStats {
+    std::uint64_t decisions = 0;
+    std::uint64_t nodes = 0;
+    std::uint64_t depthTotal = 0;
+    int maxDepth = 0;
+    double seconds = 0.0;                    // 判断にかかった時間の合計
+    // 判断ごとにかかった時間（マイクロ秒）。直近 LATENCY_SAMPLES 回分だけを、古いものから上書きして持つ
+    // （長く遊ばせてもメモリを確保し直さないように、BeamBot が最初に全部確保しておく）
+    static const int LATENCY_SAMPLES = 1 << 14;
+    std::vector<std::uint32_t> latencies;
+
+    double nodesPerSecond() const { return seconds > 0.0 ? nodes / seconds : 0.0; }
+    double averageDepth() const { return decisions ? static_cast<double>(depthTotal) / decisions : 0.0; }
+    std::uint32_t latencyPercentile(double percent) const; // percent は 0～100（記録がなければ0）
+};
+
+class BeamBot {
+public:
+    explicit BeamBot(int budgetMicroseconds = 50000);
+
+    // 出てきたばかりのピースについて、置き方と操作の列を決める（sim は変えない）
+    BotDecision decide(const Simulation& sim);
+    // Simulation を使わず、盤面・今のピース・ホールド・その後に来るピースを直接渡して決める（SolverService など）
+    // holdUsed = true なら、今のピースではもうホールドできない
+    BotDecision decide(const Board& board, PieceType current, std::optional<PieceType> hold, bool holdUsed,
+                       const PieceType* queue, int queueCount);
+    // decide した操作を sim.apply で順に入れる（置けたら true）
+    bool play(Simulation& sim);
+
+    EvalWeights weights;                     // 評価の重み
+    std::chrono::microseconds budget;        // 1つのピースにかける時間の上限
+    std::uint64_t nodeBudget = 0;            // 1つのピースで評価する局面の数の上限（0 なら数では打ち切らない）
+    int initialWidth = 32;                   // 最初のビームの幅
+    int maxWidth = 2048;                     // 幅を広げる上限
+    int maxDepth = 2 + Simulation::NEXT_COUNT; // 読む深さの上限
+    // initialWidth = maxWidth にして budget を十分長くすると、時間によらず毎回同じ手を選ぶ（重みの調整用）
+
+    const BotStats& stats() const { return counters; }
+    void resetStats();
+
+private:
+    // ビームに残す局面
+    struct Node {
+        Board board;
+        std::optional<PieceType> hold;
+        int index = 0;                       // 次に出てくるピース（pieces の位置）
+        float reward = 0.f;                  // ここまでに消したラインの分の評価値
+        float value = 0.f;                   // reward + 盤面の評価値
+        Placement first{ PieceType::T, Rotation::Spawn, 0, 0 }; // この局面に至る1手目
+    };
+    // 次の深さの候補（盤面は作らず、Board::featuresAfter で評価だけする）
+    struct Candidate {
+        int parent;
+        Placement placement;
+        std::optional<PieceType> hold;
+        int index;
+        float reward;
+        float value;
+    };
+
+    // 今のピース・ネクスト・袋から決まる次の1個
+    std::array<PieceType, 2 + Simulation::NEXT_COUNT> pieces{};
+    int pieceCount = 0;
+    bool rootHoldUsed = false;               // 最初のピースではもうホールドできない
+    std::chrono::steady_clock::time_point deadline;
+    bool timeUp = false;                     // 時間か局面数の上限に達した
+    std::uint64_t nodes = 0;
+
+    MoveGenerator gen;
+    std::array<Placement, MoveGenerator::MAX_PLACEMENTS> list;
+    // 判断のたびに使い回す（ゲーム中にメモリを確保し直さない）
+    std::vector<Node> beam, nextBeam;
+    std::vector<Candidate> candidates;
+    BotStats counters;
+
+    // 幅 width でビームサーチし、読み切った深さを返す（best に一番良い局面の1手目を入れる）
+    int search(const Node& root, int width, Placement& best);
+    bool outOfBudget() const;
+    void expand(int parent, PieceType type, bool usedHold, std::optional<PieceType> nextHold, int nextIndex, int depth);
+};
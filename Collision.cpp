@@ -0,0 +1,215 @@
+#include "Collision.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define COLLISION_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define COLLISION_X86 0
+#endif
+
+// GCC / Clang では、AVX2 を使う関数だけ AVX2 向けにコンパイルする（ほかの部分は AVX2 のない CPU でも動く）
+// MSVC は指定しなくても組み込み関数を使える
+#if COLLISION_X86 && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace {
+    using Columns = CollisionField::Columns;
+
+    // 一番下の1のビットの位置（x は 0 でないこと）
+    inline int lowestBit(std::uint32_t x) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(x);
+#endif
+    }
+
+    // ピースの行 r が、レーン yi（位置 y = yi - Y_OFFSET）のときに重なる padded の位置は base(o, r) + yi
+    inline int base(const Orientation& o, int r) {
+        return CollisionField::PAD - CollisionField::Y_OFFSET + o.minY + r;
+    }
+
+    // 左端の列 c に置けるか（壁にはみ出す c は最初から計算しない）。置けない列は -1 を返す
+    inline int leftColumn(const Orientation& o, int xi) {
+        int c = xi - CollisionField::X_OFFSET + o.minX;
+        int width = o.maxX - o.minX + 1;
+        return (c < 0 || c > Board::WIDTH - width) ? -1 : c;
+    }
+
+    // ---- どの CPU でも動く計算 ----
+    // freeRows[yi] のビット c：左端を列 c にしたとき、レーン yi の位置に置ける
+    void fitScalar(const std::uint16_t* padded, const Orientation& o, Columns& out) {
+        std::uint16_t freeRows[CollisionField::Y_RANGE];
+        for (int yi = 0; yi < CollisionField::Y_RANGE; ++yi) {
+            std::uint16_t blocked = 0;
+            for (int r = 0; r < o.height; ++r) {
+                std::uint16_t row = padded[base(o, r) + yi];
+                // ピースの行のマス dx が列 c + dx のブロックと重なる → 左端 c には置けない
+                for (int dx = 0; dx < 4; ++dx)
+                    if ((o.rowMasks[r] >> dx) & 1u) blocked |= static_cast<std::uint16_t>(row >> dx);
+            }
+            freeRows[yi] = static_cast<std::uint16_t>(~blocked);
+        }
+        for (int xi = 0; xi < CollisionField::X_RANGE; ++xi) {
+            int c = leftColumn(o, xi);
+            std::uint32_t column = 0;
+            if (c >= 0)
+                for (int yi = 0; yi < CollisionField::Y_RANGE; ++yi)
+                    column |= static_cast<std::uint32_t>((freeRows[yi] >> c) & 1u) << yi;
+            out[xi] = column;
+        }
+    }
+
+#if COLLISION_X86
+    // ---- SSE2（1レジスタに8行。32行を4レジスタで計算する） ----
+    void fitSse2(const std::uint16_t* padded, const Orientation& o, Columns& out) {
+        __m128i blocked[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+        for (int r = 0; r < o.height; ++r) {
+            const std::uint16_t* rows = padded + base(o, r);
+            for (int dx = 0; dx < 4; ++dx) {
+                if (!((o.rowMasks[r] >> dx) & 1u)) continue;
+                __m128i shift = _mm_cvtsi32_si128(dx);
+                for (int v = 0; v < 4; ++v) {
+                    __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + v * 8));
+                    blocked[v] = _mm_or_si128(blocked[v], _mm_srl_epi16(row, shift));
+                }
+            }
+        }
+        // 列 c のビットを各レーンの最上位ビットに移し、movemask で32行分のビット列にする
+        for (int xi = 0; xi < CollisionField::X_RANGE; ++xi) {
+            int c = leftColumn(o, xi);
+            if (c < 0) {
+                out[xi] = 0;
+                continue;
+            }
+            __m128i shift = _mm_cvtsi32_si128(15 - c);
+            __m128i t[4];
+            for (int v = 0; v < 4; ++v) t[v] = _mm_sll_epi16(blocked[v], shift);
+            // 16ビット→8ビットの符号付き飽和変換は符号（最上位ビット）を保つ
+            std::uint32_t low = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(t[0], t[1])));
+            std::uint32_t high = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(t[2], t[3])));
+            out[xi] = ~(low | high << 16); // blocked の反対が置ける位置
+        }
+    }
+
+    // ---- AVX2（1レジスタに16行。32行を2レジスタで計算する） ----
+    TARGET_AVX2 void fitAvx2(const std::uint16_t* padded, const Orientation& o, Columns& out) {
+        __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+        for (int r = 0; r < o.height; ++r) {
+            const std::uint16_t* rows = padded + base(o, r);
+            __m256i rowLo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows));
+            __m256i rowHi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + 16));
+            for (int dx = 0; dx < 4; ++dx) {
+                if (!((o.rowMasks[r] >> dx) & 1u)) continue;
+                __m128i shift = _mm_cvtsi32_si128(dx);
+                lo = _mm256_or_si256(lo, _mm256_srl_epi16(rowLo, shift));
+                hi = _mm256_or_si256(hi, _mm256_srl_epi16(rowHi, shift));
+            }
+        }
+        for (int xi = 0; xi < CollisionField::X_RANGE; ++xi) {
+            int c = leftColumn(o, xi);
+            if (c < 0) {
+                out[xi] = 0;
+                continue;
+            }
+            __m128i shift = _mm_cvtsi32_si128(15 - c);
+            // packs は128ビットごとに交互に並べるので、permute で行の順番に戻す
+            __m256i packed = _mm256_packs_epi16(_mm256_sll_epi16(lo, shift), _mm256_sll_epi16(hi, shift));
+            packed = _mm256_permute4x64_epi64(packed, 0xD8);
+            out[xi] = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(packed));
+        }
+    }
+
+    bool cpuHasAvx2() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        // OS が AVX のレジスタを保存してくれるか（OSXSAVE と AVX のビット、XCR0 の SSE・AVX の状態）
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return false;
+        if ((_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif
+}
+
+// ==================== CollisionField クラス ====================
+CollisionField::CollisionField(const Board& board) {
+    const std::uint16_t WALL = static_cast<std::uint16_t>(~Board::FULL_ROW);
+    for (int i = 0; i < PADDED_ROWS; ++i) {
+        int y = i - PAD;
+        if (y < 0) padded[i] = WALL;                     // 盤面の上は空（壁だけ）
+        else if (y >= Board::HEIGHT) padded[i] = 0xFFFF; // 床
+        else padded[i] = static_cast<std::uint16_t>(board.rows[y] | WALL);
+    }
+}
+
+void CollisionField::fitColumns(const Orientation& o, Columns& out) const {
+    static const Backend best = bestBackend();
+    fitColumns(o, out, best);
+}
+
+void CollisionField::fitColumns(const Orientation& o, Columns& out, Backend backend) const {
+#if COLLISION_X86
+    if (backend == Backend::Avx2) return fitAvx2(padded.data(), o, out);
+    if (backend == Backend::Sse2) return fitSse2(padded.data(), o, out);
+#endif
+    (void)backend;
+    fitScalar(padded.data(), o, out);
+}
+
+// (x, y) から下へ続く「置ける」ビットの長さ - 1 が落ちられる段数
+int CollisionField::dropDistance(const Columns& columns, int x, int y) {
+    int above = 0;
+    if (y < -Y_OFFSET) {
+        above = -Y_OFFSET - y; // 範囲より上の部分は空いている
+        y = -Y_OFFSET;
+    }
+    std::uint32_t blocked = ~(columns[x + X_OFFSET] >> (y + Y_OFFSET)); // 床の下は必ず置けないので 0 にはならない
+    return above + lowestBit(blocked) - 1;
+}
+
+int CollisionField::landingY(const Columns& columns, int x) {
+    if (!(columns[x + X_OFFSET] & 1u)) return NO_LANDING;
+    return dropDistance(columns, x, -Y_OFFSET) - Y_OFFSET;
+}
+
+bool CollisionField::supported(Backend backend) {
+#if COLLISION_X86
+    if (backend == Backend::Avx2) {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+    return true; // x86 の64ビット CPU には必ず SSE2 がある（32ビットでも現在の CPU ならある）
+#else
+    return backend == Backend::Scalar;
+#endif
+}
+
+CollisionField::Backend CollisionField::bestBackend() {
+    if (supported(Backend::Avx2)) return Backend::Avx2;
+    if (supported(Backend::Sse2)) return Backend::Sse2;
+    return Backend::Scalar;
+}
+
+const char* CollisionField::nameOf(Backend backend) {
+    switch (backend) {
+    case Backend::Avx2: return "avx2";
+    case Backend::Sse2: return "sse2";
+    default:            return "scalar";
+    }
+}
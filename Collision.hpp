@@ -0,0 +1,50 @@
+#pragma once
+#include "Board.hpp"
+#include "PieceTable.hpp"
+#include <array>
+#include <cstdint>
+
+// ==== まとめて当たり判定をするクラス ====
+// Piece::canMove や Board::fits は1つの位置ずつ調べるが、手生成やハードドロップでは
+// 「この向きのピースを、どの (x, y) に置けるか」を全部知りたい
+// 盤面の各行を16ビットの値として SIMD レジスタに並べ（1レジスタ = 16行 or 8行）、
+// 全部の y を一度に調べて、列ごとに「置ける y」をビット列にする
+// ・CPU が AVX2 を使えれば AVX2、なければ SSE2、x86 以外ではふつうのループで計算する（実行時に選ぶ）
+// ・どの方法でも結果は同じ（Bench が全部の方法を Board::fits と突き合わせて確かめる）
+class CollisionField {
+public:
+    // x は -2..13、y は -4..27 の範囲だけを扱う（MoveGenerator と同じ範囲）
+    static const int X_OFFSET = 2, X_RANGE = 16;
+    static const int Y_OFFSET = 4, Y_RANGE = 32;
+
+    // columns[x + X_OFFSET] のビット (y + Y_OFFSET) が立っていれば、(x, y) にピースを置ける
+    using Columns = std::array<std::uint32_t, X_RANGE>;
+
+    enum class Backend { Scalar, Sse2, Avx2 };
+
+    explicit CollisionField(const Board& board);
+
+    // 向き o のピースを置ける位置を列ごとに求める（この CPU で使える一番速い方法で計算する）
+    void fitColumns(const Orientation& o, Columns& out) const;
+    // 計算方法を指定する（速さの比較・結果の確認用。backend は supported であること）
+    void fitColumns(const Orientation& o, Columns& out, Backend backend) const;
+
+    // (x, y) に置けるピースが、そこから何段下まで落ちられるか
+    // (x, y) に置けること。y が範囲より上なら、盤面の上は空いているものとして数える
+    static int dropDistance(const Columns& columns, int x, int y);
+    // 盤面の上から落としたときに止まる y（その列に置けなければ NO_LANDING）
+    static const int NO_LANDING = -100;
+    static int landingY(const Columns& columns, int x);
+
+    static bool supported(Backend backend);
+    static Backend bestBackend();            // fitColumns(o, out) が使う方法
+    static const char* nameOf(Backend backend);
+
+    // 盤面の上下に余白を付けた行データ
+    // 列10～15 のビットは右の壁、盤面より下は床（全ビット1）、盤面より上は壁だけ
+    static const int PAD = 8;
+    static const int PADDED_ROWS = 48;
+
+private:
+    alignas(32) std::array<std::uint16_t, PADDED_ROWS> padded;
+};
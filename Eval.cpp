@@ -0,0 +1,55 @@
+#include "Eval.hpp"
+#include <bitset>
+#include <cstdlib>
+
+// 盤面全体から特徴を数える（行のビット列を使うので、200マスを1つずつ見るより速い）
+FieldFeatures computeFeatures(const Board& board) {
+    FieldFeatures f;
+
+    // --- 列の高さと穴 ---
+    // 上の行から順に見て、「ここより上にブロックがある列」のビット列を作っていく
+    // その列の空きマスが穴になる
+    std::uint16_t covered = 0;
+    for (int y = 0; y < Board::HEIGHT; ++y) {
+        std::uint16_t row = board.rows[y];
+        std::uint16_t newTops = row & static_cast<std::uint16_t>(~covered);
+        for (int x = 0; x < Board::WIDTH; ++x)
+            if ((newTops >> x) & 1u) f.heights[x] = Board::HEIGHT - y;
+        f.holes += static_cast<int>(std::bitset<16>(covered & static_cast<std::uint16_t>(~row)).count());
+        covered |= row;
+
+        // --- 横方向の切り替わり（左右の壁はブロック扱い） ---
+        // ブロックのない行（スタックより上）は数えない
+        if (row != 0) {
+            std::uint32_t walled = (static_cast<std::uint32_t>(row) << 1) | 1u | (1u << (Board::WIDTH + 1));
+            f.rowTransitions += static_cast<int>(std::bitset<32>((walled ^ (walled >> 1)) & ((1u << (Board::WIDTH + 1)) - 1)).count());
+        }
+    }
+
+    // --- 高さ・でこぼこ・井戸 ---
+    for (int x = 0; x < Board::WIDTH; ++x) {
+        int h = f.heights[x];
+        f.aggregateHeight += h;
+        if (h > f.maxHeight) f.maxHeight = h;
+        if (x + 1 < Board::WIDTH) f.bumpiness += std::abs(h - f.heights[x + 1]);
+
+        int left = x > 0 ? f.heights[x - 1] : Board::HEIGHT;
+        int right = x + 1 < Board::WIDTH ? f.heights[x + 1] : Board::HEIGHT;
+        int rim = left < right ? left : right;
+        if (rim > h) f.wellDepth += rim - h;
+    }
+    return f;
+}
+
+float scoreFeatures(const FieldFeatures& f, const EvalWeights& w) {
+    return w.aggregateHeight * f.aggregateHeight
+         + w.maxHeight * f.maxHeight
+         + w.holes * f.holes
+         + w.bumpiness * f.bumpiness
+         + w.wellDepth * f.wellDepth
+         + w.rowTransitions * f.rowTransitions;
+}
+
+float evaluate(const Board& board, const EvalWeights& w) {
+    return scoreFeatures(board.features, w);
+}
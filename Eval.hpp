@@ -0,0 +1,29 @@
+#pragma once
+#include "Board.hpp"
+#include <array>
+
+// ==== 盤面の評価 ====
+// 置き方の候補を比べるために、盤面の「形の良さ」を数値にする
+// 盤面からいくつかの特徴（列の高さ・穴の数など）を数え、それぞれに重みを掛けて足した値を評価値とする
+// （評価値が大きいほど良い盤面）
+// 特徴（FieldFeatures）は Board が置くたび・消すたびに差分で更新しているので、ふだんは board.features を使う
+
+// 評価の重み
+struct EvalWeights {
+    float aggregateHeight = -0.51f;
+    float maxHeight = -0.05f;
+    float holes = -0.36f;
+    float bumpiness = -0.18f;
+    float wellDepth = -0.10f;
+    float rowTransitions = -0.12f;
+    float lines = 0.76f;                     // 消したライン1本あたり
+};
+
+// 盤面全体から特徴を数える（Board::features の差分更新が正しいかの確認用）
+FieldFeatures computeFeatures(const Board& board);
+
+// 特徴に重みを掛けて足した評価値（ライン消去の分は含まない）
+float scoreFeatures(const FieldFeatures& f, const EvalWeights& w);
+
+// 盤面の評価値（board.features + scoreFeatures）
+float evaluate(const Board& board, const EvalWeights& w);
@@ -0,0 +1,193 @@
+#include "Game.hpp"
+#include "Trace.hpp"
+#include <cstdio>
+#include <iostream>
+
+// キーと操作の対応（対応しないキーは Action::None）
+static Action actionOf(sf::Keyboard::Key key) {
+    switch (key) {
+    case sf::Keyboard::Left:  return Action::MoveLeft;   // 左移動
+    case sf::Keyboard::Right: return Action::MoveRight;  // 右移動
+    case sf::Keyboard::Down:  return Action::SoftDrop;   // 下移動
+    case sf::Keyboard::Z:     return Action::RotateCCW;  // 左回転
+    case sf::Keyboard::X:     return Action::RotateCW;   // 右回転
+    case sf::Keyboard::Up:    return Action::MoveUp;     // 上移動（↑キーで1段上げる）
+    case sf::Keyboard::Space: return Action::HardDrop;   // ハードドロップ（スペースキー）
+    case sf::Keyboard::C:     return Action::Hold;       // Hold機能
+    default:                  return Action::None;
+    }
+}
+
+// ==================== Game クラス ====================
+// コンストラクタ：ウィンドウ生成（ピースとNextキューは Simulation が準備する）
+Game::Game(double botPps)
+    : window(sf::VideoMode(Board::WIDTH * 40 + 200, Board::HEIGHT * 40), "Tetris"),
+    scheduler(TICKS_PER_SECOND),
+    botPps(botPps)
+{
+    // 押しっぱなしのときにOSが送ってくる KeyPressed の繰り返しは使わない（リピートは InputRepeater が行う）
+    window.setKeyRepeatEnabled(false);
+    // パフェのデータベースは任意（ファイルがなければ、おすすめは先読みだけで計算する）
+    if (pcDatabase.open(PC_DATABASE_PATH)) advisor.pcDatabase = &pcDatabase;
+    // Bot は1手を置く間隔の半分までで判断する（残りは描画とおすすめの計算に回す）
+    if (botPps > 0.0) {
+        botInterval = std::chrono::duration_cast<InputClock::duration>(std::chrono::duration<double>(1.0 / botPps));
+        auto limit = std::chrono::duration_cast<std::chrono::microseconds>(botInterval / 2);
+        if (limit < bot.budget) bot.budget = limit;
+    }
+    //std::cout << "コンストラクタ: Current piece is " << toString(sim.current().type) << std::endl;
+}
+
+// メインループ（イベント処理・ティックの更新・描画を繰り返す）
+// 全力でループを回すのではなく、次のティックの時刻まで眠ってCPUを空ける
+void Game::run() {
+    // 自動落下の間隔をティック数にする（落下は Simulation::tick の中で行われる）
+    sim.gravity = static_cast<int>(fallInterval * TICKS_PER_SECOND);
+    scheduler.restart();
+    nextBotMove = InputClock::now();
+
+    while (window.isOpen()) {
+        // おすすめの計算スレッド（PlacementAdvisor）の確保も含めて、プロセス全体で数える
+        std::uint64_t allocationsBefore = heap::allocations();
+        handleEvents();
+        handleInput();
+        playBot();
+
+        // 前のループから今までに過ぎた分だけティックを進める
+        int due = scheduler.ticksDue();
+        for (int i = 0; i < due; ++i) update();
+        updateAdvice();
+
+        // ティックが進んだとき・入力でピースが動いたとき・おすすめが変わったときだけ描き直す
+        if (due > 0 || needsRedraw) {
+            render();
+            needsRedraw = false;
+        }
+        countAllocations(heap::allocations() - allocationsBefore);
+        scheduler.waitForNextTick(std::chrono::microseconds(INPUT_POLL_MICROSECONDS));
+
+        /*
+
+        // --- デバッグ出力 ---
+        auto abs = sim.current().getAbsolutePositions();
+        std::cout << "Current piece absolute positions: ";
+        for (auto& p : abs) {
+            std::cout << "(" << p.x << "," << p.y << ") ";
+        }
+        std::cout << std::endl;
+
+        */
+    }
+
+    if (botPps > 0.0) {
+        const BotStats& stats = bot.stats();
+        std::printf("bot: %llu pieces, depth %.2f avg / %d max, %.0f nodes/s\n",
+                    static_cast<unsigned long long>(stats.decisions), stats.averageDepth(), stats.maxDepth,
+                    stats.nodesPerSecond());
+        std::printf("bot latency (ms): p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n",
+                    stats.latencyPercentile(50) / 1000.0, stats.latencyPercentile(90) / 1000.0,
+                    stats.latencyPercentile(99) / 1000.0, stats.latencyPercentile(100) / 1000.0);
+    }
+    if (allocReport) {
+        std::printf("allocations after warm-up: %llu of %llu frames allocated (%llu times, worst %llu in one frame)\n",
+                    static_cast<unsigned long long>(frameAllocs.allocating),
+                    static_cast<unsigned long long>(frameAllocs.windows),
+                    static_cast<unsigned long long>(frameAllocs.count),
+                    static_cast<unsigned long long>(frameAllocs.worst));
+        std::printf("allocations per piece: %llu of %llu pieces allocated (worst %llu)\n",
+                    static_cast<unsigned long long>(lockAllocs.allocating),
+                    static_cast<unsigned long long>(lockAllocs.windows),
+                    static_cast<unsigned long long>(lockAllocs.worst));
+    }
+}
+
+// イベント処理（ウィンドウを閉じる・キー入力など）
+void Game::handleEvents() {
+    sf::Event event;
+    while (window.pollEvent(event)) {
+        if (event.type == sf::Event::Closed) window.close();
+        // ウィンドウの大きさが変わった・前面に戻ったときは描き直す
+        if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus) needsRedraw = true;
+        // 後ろに回ると離したイベントが届かないので、全部離したことにする
+        if (event.type == sf::Event::LostFocus) repeater.releaseAll();
+
+        // --- キー入力は受け取った時刻をつけてキューに入れる ---
+        if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased) {
+            Action action = actionOf(event.key.code);
+            if (action == Action::None) continue;
+            InputEvent e{ InputClock::now(), action, event.type == sf::Event::KeyPressed };
+            // キューがいっぱいなら先に処理して空ける（入力を捨てない）
+            if (!inputQueue.push(e)) {
+                handleInput();
+                inputQueue.push(e);
+            }
+        }
+    }
+}
+
+// 1ティック分の更新
+void Game::update() {
+    sim.tick();
+    // ゲームオーバーになったら最初からやり直す
+    if (sim.isGameOver()) sim.reset();
+}
+
+// ピースが変わったらスナップショットを渡す（前のピースの計算は中止される）
+// 結果は待たずに、公開されている最新のものを枠として表示する
+void Game::updateAdvice() {
+    if (sim.spawnCount() != advisedSpawn && !sim.isGameOver()) {
+        advisedSpawn = sim.spawnCount();
+        advisor.submit(sim);
+    }
+    if (renderer.updateOverlay(advisor.read(), advisor.generation())) needsRedraw = true;
+}
+
+// たまったキー入力と長押しのリピートを、時刻の順に Simulation に渡す
+void Game::handleInput() {
+    repeater.update(inputQueue, InputClock::now(), [this](Action action) {
+        bool moved = sim.apply(action);
+        if (moved) needsRedraw = true; // 入力で動いたら次のティックを待たずに描き直す
+
+        // --- Hold機能 ---
+        // まだこのターンでHoldを使っていない場合のみ、Simulation 側で入れ替えが行われる
+        if (action == Action::Hold && moved) TRACE_INFO(trace::Event::Hold, *sim.hold(), sim.current().type);
+        return moved;
+    });
+}
+
+// Bot の番なら、出ているピースの置き方を決めて、その操作（キー入力と同じ Action）を入れる
+// 判断が遅れて時刻を過ぎても、まとめて何手も置かずに、次は今から1間隔後にする
+void Game::playBot() {
+    if (botPps <= 0.0 || sim.isGameOver()) return;
+    InputClock::time_point now = InputClock::now();
+    if (now < nextBotMove) return;
+    nextBotMove += botInterval;
+    if (nextBotMove < now) nextBotMove = now + botInterval;
+
+    if (!bot.play(sim)) sim.reset(); // 置ける場所がなければやり直す
+    needsRedraw = true;
+}
+
+// 描画処理（変わったマスだけ頂点を書き換えて、1回の draw で描く）
+void Game::render() {
+    window.clear();
+    renderer.update(sim);
+    renderer.draw(window);
+    window.display();
+}
+
+// 暖機が終わったら、ループ1周ごとと、ピースを固定するまでごとに記録する
+// （ピースの固定は SimStats::pieces が変わったことで知る。ゲームオーバーでやり直したときも区切る）
+void Game::countAllocations(std::uint64_t allocations) {
+    if (++frames <= ALLOC_WARMUP_FRAMES) {
+        countedPieces = sim.stats().pieces;
+        return;
+    }
+    frameAllocs.add(allocations);
+    pieceAllocations += allocations;
+    if (sim.stats().pieces != countedPieces) {
+        countedPieces = sim.stats().pieces;
+        lockAllocs.add(pieceAllocations);
+        pieceAllocations = 0;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Advisor.hpp"
+#include "AllocCounter.hpp"
+#include "Bot.hpp"
+#include "Input.hpp"
+#include "Renderer.hpp"
+#include "Simulation.hpp"
+#include "TickScheduler.hpp"
+#include <SFML/Graphics.hpp>
+
+// ==== ゲーム全体を管理するクラス（SFML版のフロントエンド） ====
+// ルールは Simulation が持ち、このクラスはキー入力を Action に変換して渡し、状態を描画するだけ
+// 更新は1秒に TICKS_PER_SECOND 回の決まった間隔で行い、その間はスレッドを眠らせる
+// キー入力だけは INPUT_POLL_MICROSECONDS ごとに起きて受け取り、ティックを待たずにすぐ Simulation に渡す
+// botPps > 0 なら、Bot（BeamBot）が1秒に botPps 個のペースで、キー入力と同じ Action を Simulation に入れて遊ぶ
+// メインループ1周（イベント・入力・Bot・ティック・描画）とピース1つの固定ごとに、このスレッドのメモリ確保の回数を数える
+// 起動してから ALLOC_WARMUP_FRAMES 周までは、配列が最大の大きさまで育つ途中なので数えない
+class Game {
+public:
+    static const int TICKS_PER_SECOND = 60;  // 1秒あたりのティック数
+    static const int INPUT_POLL_MICROSECONDS = 1000; // キー入力を見に行く間隔
+    static constexpr const char* PC_DATABASE_PATH = "pc.db"; // あれば開くパフェのデータベース（PcDbBuild で作る）
+    static const int ALLOC_WARMUP_FRAMES = TICKS_PER_SECOND * 5; // メモリ確保を数え始めるまでのループの周回数
+
+    bool allocReport = false;                // 終了時にメモリ確保の回数を表示する（main.cpp の --alloc）
+
+private:
+    sf::RenderWindow window;                 // ゲームウィンドウ
+    Simulation sim;                          // ゲームのルール本体（盤面・ピース・Next・Hold）
+    Renderer renderer;                       // 盤面・ピース・Next・Hold をまとめて描画する
+    TickScheduler scheduler;                 // 次のティックまで眠るためのタイマー
+    bool needsRedraw = true;                 // ティックが進んでいなくても描き直す必要がある（ウィンドウの再表示など）
+
+    InputQueue inputQueue;                   // 時刻つきのキー入力イベント
+    InputRepeater repeater;                  // キーごとの長押し（DAS / ARR）の処理
+    PcDatabase pcDatabase;                   // パフェのデータベース（advisor より先に作り、後に壊す）
+    PlacementAdvisor advisor;                // おすすめの置き場所を別スレッドで計算する
+    std::uint64_t advisedSpawn = 0;          // どのピースまでスナップショットを渡したか（Simulation::spawnCount）
+
+    BeamBot bot;                             // 自動で遊ぶBot（botPps > 0 のときだけ使う）
+    double botPps = 0.0;                     // Bot が1秒あたりに置くピースの数
+    InputClock::duration botInterval{};      // Bot が置く間隔
+    InputClock::time_point nextBotMove;      // Bot が次に置く時刻
+
+    // ---- メモリ確保の計測（AllocCounter。全スレッドの合計） ----
+    std::uint64_t frames = 0;                // ループを回した回数
+    heap::Tally frameAllocs;                 // ループ1周ごと
+    heap::Tally lockAllocs;                  // ピース1つを固定するまでごと
+    std::uint64_t pieceAllocations = 0;      // 今のピースが出てから確保した回数
+    std::uint64_t countedPieces = 0;         // 最後に数えたときの SimStats::pieces
+
+    float fallInterval = 500.5f;               // 自動落下の間隔（秒）
+
+    sf::Font font;                           // GUI用フォント（スコアやNext表示に利用）
+
+public:
+    explicit Game(double botPps = 0.0);      // コンストラクタ（botPps > 0 なら Bot に遊ばせる）
+    void run();                              // メインループ（イベント・更新・描画を回す）
+private:
+    void handleEvents();                     // イベント処理（閉じるボタン・キー入力など）
+    void update();                           // 1ティック分の更新（自動落下）
+    void updateAdvice();                     // 新しいピースならスナップショットを渡し、新しい結果があれば描き直す
+    void handleInput();                      // 入力処理（たまったキー入力と長押しのリピートを Simulation に渡す）
+    void playBot();                          // Bot の番なら1手決めて、その操作を Simulation に渡す
+    void render();                           // 描画処理（盤面・ピース・UI表示）
+    void countAllocations(std::uint64_t allocations); // ループ1周で確保した回数を記録する
+};
@@ -0,0 +1,350 @@
+// ==== ウィンドウなしでゲームを回すプログラム ====
+// Simulation だけを使い、SFMLには依存しない（ディスプレイのないCI環境でも動く）
+// 1ピースごとに「ランダムに回転 → ランダムに左右移動 → ハードドロップ」をする簡単な操作でゲームを進める
+//
+// 使い方:
+//   Headless [置くピース数] [操作用の乱数シード]       … 指定した数のピースを置き、1秒あたりのピース数を表示する
+//   Headless record <ファイル> [ゲーム数] [シード]     … ゲームをリプレイとして記録する（連結して1ファイルに書く）
+//   Headless replay <ファイル>                         … ファイル内のリプレイをすべて再生し、記録と一致するか調べる
+//   Headless bot [ピース数] [PPS] [1手の時間(ms)] [シード] … ビームサーチのBot（Bot.hpp）に遊ばせ、
+//                                                        読めた深さ・局面数/秒・判断時間の分布を表示する（PPS 0 なら待たずに次を置く）
+//   Headless alloc [ピース数] [シード]                  … ランダムな操作と Bot で交互に置き、おすすめ（PlacementAdvisor）にも
+//                                                        毎回計算させて、起動直後を除いて1ピースの間に（どのスレッドでも）
+//                                                        1回でもメモリを確保したら失敗する（終了コード1）
+//   Headless input                                     … 決まった押し方で InputRepeater が何回動かすかを調べる
+//                                                        （1回のタップで1回だけ動くかなど。合わなければ終了コード1）
+#include "Advisor.hpp"
+#include "AllocCounter.hpp"
+#include "Bot.hpp"
+#include "Input.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // ランダムな操作で1ピース置く。操作は input(Action) を通して入れる（入力できたら true を返すこと）
+    template <class Input>
+    void playRandomPiece(std::mt19937& rng, Input input) {
+        // ときどきホールドを使う
+        if (rng() % 8 == 0) input(Action::Hold);
+
+        // 0～3回右回転
+        int turns = static_cast<int>(rng() % 4);
+        for (int i = 0; i < turns; ++i) input(Action::RotateCW);
+
+        // -5～+5マス左右に動かす（壁に当たったらそこで止まる）
+        int shift = static_cast<int>(rng() % 11) - 5;
+        Action dir = shift < 0 ? Action::MoveLeft : Action::MoveRight;
+        for (int i = 0; i < (shift < 0 ? -shift : shift); ++i)
+            if (!input(dir)) break;
+
+        input(Action::HardDrop);
+    }
+
+    // 速さを測る（ゲームオーバーになったら次のゲームへ）
+    int runThroughput(long long pieceLimit, unsigned seed) {
+        Simulation sim;
+        std::mt19937 rng(seed);
+        long long games = 1, pieces = 0, lines = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        while (pieces < pieceLimit) {
+            playRandomPiece(rng, [&](Action a) { return sim.apply(a); });
+            ++pieces;
+            lines += sim.lastLock().linesCleared;
+
+            if (sim.isGameOver()) {
+                sim.reset();
+                ++games;
+            }
+        }
+        double seconds = secondsSince(start);
+
+        std::printf("pieces: %lld, games: %lld, lines: %lld\n", pieces, games, lines);
+        std::printf("time: %.3f s, %.0f pieces/s\n", seconds, pieces / seconds);
+        return 0;
+    }
+
+    // Bot に遊ばせる。pps > 0 なら1秒あたり pps 個になるように待ちながら置く
+    int runBot(long long pieceLimit, double pps, int budgetMilliseconds, unsigned seed) {
+        Simulation sim;
+        sim.reset(seed);
+        BeamBot bot(budgetMilliseconds * 1000);
+        auto interval = std::chrono::steady_clock::duration::zero();
+        if (pps > 0) {
+            interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / pps));
+            // 判断は間隔の8割までに終わらせる
+            auto limit = std::chrono::duration_cast<std::chrono::microseconds>(interval * 4 / 5);
+            if (limit < bot.budget) bot.budget = limit;
+        }
+        long long games = 1, pieces = 0, lines = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        auto next = start;
+        while (pieces < pieceLimit) {
+            if (pps > 0) {
+                std::this_thread::sleep_until(next);
+                next += interval;
+            }
+            // 置ける場所がない（盤面より上にはみ出すしかない）ときもゲームオーバーとして扱う
+            bool placed = bot.play(sim);
+            if (placed) {
+                ++pieces;
+                lines += sim.lastLock().linesCleared;
+            }
+            if (!placed || sim.isGameOver()) {
+                sim.reset();
+                ++games;
+            }
+        }
+        double seconds = secondsSince(start);
+
+        const BotStats& stats = bot.stats();
+        std::printf("pieces: %lld, games: %lld, lines: %lld\n", pieces, games, lines);
+        std::printf("time: %.3f s, %.1f pieces/s\n", seconds, pieces / seconds);
+        std::printf("depth: %.2f avg, %d max, %.0f nodes/s\n", stats.averageDepth(), stats.maxDepth, stats.nodesPerSecond());
+        std::printf("latency (ms): p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n",
+                    stats.latencyPercentile(50) / 1000.0, stats.latencyPercentile(90) / 1000.0,
+                    stats.latencyPercentile(99) / 1000.0, stats.latencyPercentile(100) / 1000.0);
+        return 0;
+    }
+
+    // 起動後のメモリ確保を調べる（AllocCounter.cpp で operator new を数える）
+    // 最初の ALLOC_WARMUP 個は配列が最大の大きさまで育つ途中なので数えない。そのあとは、1ピース分
+    // （おすすめへのスナップショットの受け渡しと計算・操作・ティック・Bot の判断・固定・ゲームオーバーからのやり直し）
+    // ごとに、全スレッドで確保した回数を数える（おすすめは別スレッドで計算するので、このスレッドの分だけでは足りない）
+    // Bot は幅を固定し、時間ではなく幅で読みを打ち切る（実行のたびに同じ手になるように）
+    int runAllocCheck(long long pieceLimit, unsigned seed) {
+        const long long ALLOC_WARMUP = 200;
+        const int GRAVITY = 20;
+        const int ADVISOR_BUDGET_MS = 20;
+        const auto ADVISOR_WAIT = std::chrono::milliseconds(200);
+        Simulation sim;
+        sim.gravity = GRAVITY;
+        sim.reset(seed);
+        BeamBot bot;
+        bot.initialWidth = bot.maxWidth = 64;
+        bot.budget = std::chrono::hours(1);
+        PlacementAdvisor advisor(ADVISOR_BUDGET_MS);
+        std::mt19937 rng(seed);
+        heap::Tally randomPieces, botPieces;
+        long long advised = 0;
+
+        for (long long i = 0; i < ALLOC_WARMUP + pieceLimit; ++i) {
+            std::uint64_t before = heap::allocations();
+            // ゲームと同じく、ピースが出るたびにスナップショットを渡し、1手目の結果が出るまで待ってから置く
+            std::uint64_t generation = advisor.submit(sim);
+            auto waitUntil = std::chrono::steady_clock::now() + ADVISOR_WAIT;
+            for (;;) {
+                const AdvisorResult& result = advisor.read();
+                if (result.generation == generation && result.depth > 0) {
+                    ++advised;
+                    break;
+                }
+                if (std::chrono::steady_clock::now() >= waitUntil) break;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            bool byBot = i % 2 == 1;
+            bool placed = true;
+            if (byBot) {
+                placed = bot.play(sim);
+                sim.tick();
+            }
+            else {
+                playRandomPiece(rng, [&](Action a) {
+                    if (sim.isGameOver()) return false;
+                    bool moved = sim.apply(a);
+                    sim.tick();
+                    return moved;
+                });
+            }
+            if (!placed || sim.isGameOver()) sim.reset();
+            std::uint64_t allocations = heap::allocations() - before;
+            if (i >= ALLOC_WARMUP) (byBot ? botPieces : randomPieces).add(allocations);
+        }
+
+        std::printf("random pieces: %llu, allocating: %llu (%llu allocations, worst %llu)\n",
+                    static_cast<unsigned long long>(randomPieces.windows),
+                    static_cast<unsigned long long>(randomPieces.allocating),
+                    static_cast<unsigned long long>(randomPieces.count),
+                    static_cast<unsigned long long>(randomPieces.worst));
+        std::printf("bot pieces: %llu, allocating: %llu (%llu allocations, worst %llu)\n",
+                    static_cast<unsigned long long>(botPieces.windows),
+                    static_cast<unsigned long long>(botPieces.allocating),
+                    static_cast<unsigned long long>(botPieces.count),
+                    static_cast<unsigned long long>(botPieces.worst));
+        std::printf("advisor results: %lld of %lld pieces\n", advised, ALLOC_WARMUP + pieceLimit);
+        bool clean = randomPieces.allocating == 0 && botPieces.allocating == 0;
+        std::printf("%s\n", clean ? "ok: no allocations after warm-up" : "FAILED: steady-state play allocates");
+        return clean ? 0 : 1;
+    }
+
+    // ゲームを最後まで遊んで記録する
+    // 操作1つごとに1ティック進め、gravity ティックごとに自然落下させる
+    int runRecord(const char* path, long long gameCount, unsigned seed) {
+        const int GRAVITY = 20;
+        Simulation sim;
+        sim.gravity = GRAVITY;
+        std::mt19937 rng(seed);
+        ReplayWriter writer;
+        std::vector<std::uint8_t> archive;
+        long long inputs = 0;
+
+        for (long long g = 0; g < gameCount; ++g) {
+            std::uint32_t gameSeed = rng();
+            sim.reset(gameSeed);
+            if (!writer.begin(gameSeed, GRAVITY)) {
+                std::fprintf(stderr, "gravity %d does not fit in a replay header\n", GRAVITY);
+                return 1;
+            }
+            while (!sim.isGameOver()) {
+                playRandomPiece(rng, [&](Action a) {
+                    if (sim.isGameOver()) return false;
+                    writer.record(sim.stats().ticks, a);
+                    bool moved = sim.apply(a);
+                    sim.tick();
+                    return moved;
+                });
+            }
+            writer.finish(sim);
+            inputs += writer.eventCount();
+            archive.insert(archive.end(), writer.bytes().begin(), writer.bytes().end());
+        }
+
+        if (!saveReplayFile(path, archive)) {
+            std::fprintf(stderr, "cannot write %s\n", path);
+            return 1;
+        }
+        std::printf("games: %lld, inputs: %lld, bytes: %zu (%.2f bytes/input)\n",
+                    gameCount, inputs, archive.size(), static_cast<double>(archive.size()) / inputs);
+        return 0;
+    }
+
+    // ファイル内のリプレイをすべて再生して確かめる
+    int runReplay(const char* path) {
+        std::vector<std::uint8_t> archive;
+        if (!loadReplayFile(path, archive)) {
+            std::fprintf(stderr, "cannot read %s\n", path);
+            return 1;
+        }
+
+        Simulation sim;
+        long long games = 0, mismatched = 0, pieces = 0;
+        std::size_t offset = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (offset < archive.size()) {
+            ReplayCheck check = verifyReplay(archive.data() + offset, archive.size() - offset, sim);
+            if (!check.valid) {
+                std::fprintf(stderr, "broken replay at byte %zu\n", offset);
+                return 1;
+            }
+            if (!check.matched) {
+                std::printf("game %lld: mismatch (hash %016llx, ticks %llu, pieces %llu)\n", games,
+                            static_cast<unsigned long long>(check.hash),
+                            static_cast<unsigned long long>(check.ticks),
+                            static_cast<unsigned long long>(check.pieces));
+                ++mismatched;
+            }
+            ++games;
+            pieces += static_cast<long long>(check.pieces);
+            offset += check.bytes;
+        }
+        double seconds = secondsSince(start);
+
+        std::printf("games: %lld, mismatched: %lld, pieces: %lld\n", games, mismatched, pieces);
+        std::printf("time: %.3f s, %.0f games/s, %.0f pieces/s\n", seconds, games / seconds, pieces / seconds);
+        return mismatched == 0 ? 0 : 1;
+    }
+}
+
+namespace {
+    // ==== 長押しの処理の確認 ====
+    // キーを press ミリ秒後に押して release ミリ秒後に離し、end ミリ秒後まで処理したときに動いた回数を数える
+    // 動ける回数は wall 回まで（それ以上は apply が false を返す。壁に当たった状態）
+    struct InputCase {
+        const char* name;
+        Action action;
+        RepeatSetting setting;
+        int pressMs, releaseMs, endMs;
+        int wall;
+        int expected;
+    };
+
+    int countMoves(const InputCase& c) {
+        using std::chrono::milliseconds;
+        InputRepeater repeater;
+        repeater.setRepeat(c.action, c.setting);
+        InputQueue queue;
+        const InputClock::time_point start = InputClock::now();
+        queue.push(InputEvent{ start + milliseconds(c.pressMs), c.action, true });
+        queue.push(InputEvent{ start + milliseconds(c.releaseMs), c.action, false });
+        int moves = 0;
+        repeater.update(queue, start + milliseconds(c.endMs), [&](Action a) {
+            if (a != c.action || moves >= c.wall) return false;
+            ++moves;
+            return true;
+        });
+        return moves;
+    }
+
+    int runInputCheck() {
+        using std::chrono::milliseconds;
+        const RepeatSetting shift{ true, milliseconds(133), milliseconds(33) };
+        const RepeatSetting softDrop{ true, milliseconds(0), milliseconds(16) };
+        const RepeatSetting instant{ true, milliseconds(0), milliseconds(0) };
+        const RepeatSetting once{ false, milliseconds(0), milliseconds(0) };
+        const InputCase CASES[] = {
+            { "shift tap",            Action::MoveRight, shift,    0, 50,  500, 100, 1 },
+            { "shift hold 200ms",     Action::MoveRight, shift,    0, 200, 500, 100, 4 },  // 0, 133, 166, 199
+            { "soft drop tap",        Action::SoftDrop,  softDrop, 0, 5,   500, 100, 1 },
+            { "soft drop hold 50ms",  Action::SoftDrop,  softDrop, 0, 50,  500, 100, 4 },  // 0, 16, 32, 48
+            { "das 0 arr 0 tap",      Action::MoveLeft,  instant,  0, 5,   500, 4,   4 },  // 押した瞬間に壁まで
+            { "rotate hold",          Action::RotateCW,  once,     0, 500, 500, 100, 1 },
+        };
+
+        int failed = 0;
+        for (const InputCase& c : CASES) {
+            int moves = countMoves(c);
+            bool ok = moves == c.expected;
+            if (!ok) ++failed;
+            std::printf("%-22s moves %d, expected %d%s\n", c.name, moves, c.expected, ok ? "" : "  FAILED");
+        }
+        return failed == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && std::strcmp(argv[1], "record") == 0) {
+        long long games = argc > 3 ? std::atoll(argv[3]) : 1;
+        unsigned seed = argc > 4 ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)) : 1u;
+        return runRecord(argv[2], games, seed);
+    }
+    if (argc > 2 && std::strcmp(argv[1], "replay") == 0) return runReplay(argv[2]);
+    if (argc > 1 && std::strcmp(argv[1], "bot") == 0) {
+        long long pieces = argc > 2 ? std::atoll(argv[2]) : 1000;
+        double pps = argc > 3 ? std::atof(argv[3]) : 0.0;
+        int budget = argc > 4 ? std::atoi(argv[4]) : 20;
+        unsigned seed = argc > 5 ? static_cast<unsigned>(std::strtoul(argv[5], nullptr, 10)) : 1u;
+        return runBot(pieces, pps, budget, seed);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "alloc") == 0) {
+        long long pieces = argc > 2 ? std::atoll(argv[2]) : 2000;
+        unsigned seed = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 1u;
+        return runAllocCheck(pieces, seed);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "input") == 0) return runInputCheck();
+
+    long long pieceLimit = argc > 1 ? std::atoll(argv[1]) : 1000000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1u;
+    return runThroughput(pieceLimit, seed);
+}
@@ -0,0 +1,45 @@
+#include "Input.hpp"
+
+// ==================== InputQueue クラス ====================
+bool InputQueue::push(const InputEvent& e) {
+    if (count == CAPACITY) return false;
+    items[(head + count) % CAPACITY] = e;
+    ++count;
+    return true;
+}
+
+bool InputQueue::pop(InputEvent& e) {
+    if (count == 0) return false;
+    e = items[head];
+    head = (head + 1) % CAPACITY;
+    --count;
+    return true;
+}
+
+// ==================== InputRepeater クラス ====================
+// コンストラクタ：標準の長押し設定
+InputRepeater::InputRepeater() {
+    using std::chrono::milliseconds;
+    RepeatSetting shift{ true, milliseconds(133), milliseconds(33) };   // 左右移動
+    setRepeat(Action::MoveLeft, shift);
+    setRepeat(Action::MoveRight, shift);
+    setRepeat(Action::MoveUp, shift);
+    setRepeat(Action::SoftDrop, RepeatSetting{ true, milliseconds(0), milliseconds(16) });
+    // 回転・ホールド・ハードドロップは押した瞬間の1回だけ（settings の初期値のまま）
+}
+
+void InputRepeater::setRepeat(Action action, const RepeatSetting& setting) {
+    settings[static_cast<int>(action)] = setting;
+}
+
+void InputRepeater::releaseAll() {
+    for (KeyState& key : keys) key = KeyState();
+}
+
+Action InputRepeater::opposite(Action action) {
+    switch (action) {
+    case Action::MoveLeft: return Action::MoveRight;
+    case Action::MoveRight: return Action::MoveLeft;
+    default: return Action::None;
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+#include "Action.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// ==== キー入力の受け取りと長押しの処理 ====
+// キーを押した・離したというイベントを、時刻つきでキューにためておき、時刻の順に Simulation に渡す
+// ・一定間隔でキーの状態を見に行く方式と違って、短いタップも取りこぼさない
+// ・長押しはキーごとに DAS（リピートが始まるまでの時間）と ARR（リピートの間隔）で処理する
+// ・リピートの時刻はフレームやティックに丸めず、押した時刻から正確に計算する
+// SFMLには依存しない（キーと Action の対応は Game 側で決める）
+
+using InputClock = std::chrono::steady_clock;
+
+// キーを押した・離したイベント（キーは対応する Action で表す）
+struct InputEvent {
+    InputClock::time_point time;             // イベントを受け取った時刻
+    Action action;
+    bool pressed;                            // true = 押した、false = 離した
+};
+
+// イベントをためておく固定長のリングバッファ（メモリ確保をしない）
+class InputQueue {
+public:
+    static const int CAPACITY = 64;
+
+    bool push(const InputEvent& e);          // いっぱいなら false（先に取り出して処理すること）
+    bool pop(InputEvent& e);                 // 空なら false
+    bool empty() const { return count == 0; }
+    const InputEvent& front() const { return items[head]; }
+
+private:
+    std::array<InputEvent, CAPACITY> items{};
+    int head = 0, count = 0;
+};
+
+// 長押しの設定（キーごと）
+struct RepeatSetting {
+    bool repeat = false;                     // 長押しでリピートするか（回転・ホールド・ハードドロップはしない）
+    std::chrono::microseconds das{ 0 };      // 押してからリピートが始まるまでの時間
+    std::chrono::microseconds arr{ 0 };      // リピートの間隔（0なら、動けなくなるまで一気に動かす）
+};
+
+// ==== イベントと長押しのリピートを、時刻の順に操作にするクラス ====
+class InputRepeater {
+public:
+    static const int ACTION_COUNT = static_cast<int>(Action::MoveUp) + 1;
+
+    InputRepeater();                         // 標準の設定（左右 DAS 133ms / ARR 33ms、ソフトドロップ ARR 16ms）
+
+    void setRepeat(Action action, const RepeatSetting& setting);
+    const RepeatSetting& repeatOf(Action action) const { return settings[static_cast<int>(action)]; }
+
+    // now までにたまったイベントとリピートを時刻の順に apply(Action) に渡す
+    // apply は Simulation::apply と同じく、動けたら true を返すこと
+    template <class Apply>
+    void update(InputQueue& queue, InputClock::time_point now, Apply apply);
+
+    void releaseAll();                       // すべてのキーを離した状態にする（ウィンドウが後ろに回ったときなど）
+
+private:
+    // キー1つ分の状態
+    struct KeyState {
+        bool held = false;                   // 押されている
+        bool suspended = false;              // 反対方向のキーが後から押されたので、リピートを止めている
+        InputClock::time_point nextRepeat;   // 次にリピートする時刻
+    };
+
+    std::array<RepeatSetting, ACTION_COUNT> settings;
+    std::array<KeyState, ACTION_COUNT> keys;
+
+    static Action opposite(Action action);   // 左右のように同時に押すと打ち消し合うキー（なければ None）
+    template <class Apply>
+    void handle(const InputEvent& e, Apply& apply);
+    template <class Apply>
+    void repeatUntil(InputClock::time_point t, Apply& apply);
+};
+
+// ==== テンプレートの実装（ヘッダに書く必要がある） ====
+
+template <class Apply>
+void InputRepeater::update(InputQueue& queue, InputClock::time_point now, Apply apply) {
+    InputEvent e;
+    while (queue.pop(e)) {
+        // イベントより前の時刻に来ているリピートを先に処理してから、イベントを処理する
+        repeatUntil(e.time, apply);
+        handle(e, apply);
+    }
+    repeatUntil(now, apply);
+}
+
+template <class Apply>
+void InputRepeater::handle(const InputEvent& e, Apply& apply) {
+    int id = static_cast<int>(e.action);
+    KeyState& key = keys[id];
+    Action other = opposite(e.action);
+
+    if (e.pressed) {
+        if (key.held) return; // OSのキーリピートなどで重複して届いたもの
+        key.held = true;
+        key.suspended = false;
+        key.nextRepeat = e.time + settings[id].das;
+        // 反対方向のキーは、後から押したほうを優先する
+        if (other != Action::None) keys[static_cast<int>(other)].suspended = true;
+        apply(e.action); // 押した瞬間に1回動かす
+        // DAS 0 のとき、最初のリピートは押した瞬間の1回から ARR だけ後（同じ時刻にもう1回動かさない）
+        // ARR も 0 なら、押した瞬間に動けなくなるまで動かす
+        if (settings[id].repeat && settings[id].das.count() == 0) {
+            if (settings[id].arr.count() == 0) repeatUntil(e.time, apply);
+            else key.nextRepeat = e.time + settings[id].arr;
+        }
+    }
+    else {
+        key.held = false;
+        // 反対方向のキーがまだ押されていれば、そちらのリピートを DAS から数え直して再開する
+        if (other != Action::None) {
+            KeyState& o = keys[static_cast<int>(other)];
+            if (o.held && o.suspended) {
+                o.suspended = false;
+                o.nextRepeat = e.time + settings[static_cast<int>(other)].das;
+            }
+        }
+    }
+}
+
+// 時刻 t までに来るリピートを、早いものから順に処理する
+template <class Apply>
+void InputRepeater::repeatUntil(InputClock::time_point t, Apply& apply) {
+    for (;;) {
+        int best = -1;
+        for (int id = 0; id < ACTION_COUNT; ++id) {
+            const KeyState& key = keys[id];
+            if (!key.held || key.suspended || !settings[id].repeat || key.nextRepeat > t) continue;
+            if (best < 0 || key.nextRepeat < keys[best].nextRepeat) best = id;
+        }
+        if (best < 0) return;
+
+        KeyState& key = keys[best];
+        Action action = static_cast<Action>(best);
+        if (settings[best].arr.count() == 0) {
+            // ARR 0：動けなくなるまで一気に動かす（押している間は毎回壁まで寄せる）
+            while (apply(action)) {}
+            key.nextRepeat = t + std::chrono::microseconds(1);
+        }
+        else {
+            apply(action);
+            key.nextRepeat += settings[best].arr;
+        }
+    }
+}
@@ -0,0 +1,313 @@
+// ==== たくさんの対戦を1つのプロセスで回すプログラム ====
+// 2つずつ組にしたゲーム（Simulation）を何千個も並べ、Bot どうしで対戦させ続ける（ウィンドウなし・SFML 不要）
+// ・ゲームは1つの配列に並べておき、BATCH 個ずつのまとまりをスレッドプール（ThreadPool）のタスクにして1ティック進める
+//   （1つのタスクが触るのは配列の続いた範囲だけなので、キャッシュに乗ったまま処理できる）
+// ・組の相手は配列の反対側（i と i + N/2）に置くので、ふつうは別のワーカーが動かしている
+//   攻撃（ガベージ）は相手の受信キュー（ロックを使わない1対1のリングバッファ）に入れて渡す
+// ・受け取る側は、前のティックまでに送られた分だけを取り出す（スレッドの実行順によらず、同じシードなら同じ対戦になる）
+// ・ガベージは受け取ったらすぐにはせり上げず、ラインを消さずに固定したときにまとめてせり上げる
+//   ラインを消したときの攻撃は、まず受け取ったガベージと相殺する
+// ・どちらかがゲームオーバーになるか、MATCH_SECONDS 経っても決着がつかなければ（引き分け）、その組は新しいシードでやり直す
+// 最後に、ゲーム1つの1ティックにかかった時間の分布と、1コアあたりのゲーム数を表示する
+//
+// 使い方:
+//   MatchHost [ゲーム数] [ゲーム内の秒数] [PPS] [スレッド数] [シード]
+//       … ゲーム数は偶数（2つで1組）。1秒 = 60ティックとして、指定した秒数の分だけ全部のゲームを進める
+//         PPS は 1～60（1ティックに1個まで）
+#include "Bot.hpp"
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    const int TICKS_PER_SECOND = 60;         // Game と同じ
+    const int BATCH = 64;                    // 1つのタスクで進めるゲームの数
+    const int BOT_WIDTH = 4;                 // 対戦させる Bot の幅と深さ（毎回同じ手を選ぶように固定する）
+    const int BOT_DEPTH = 2;
+    const int MATCH_SECONDS = 120;           // 1つの対戦の長さの上限（ゲーム内の秒数）
+
+    // ==== ロックを使わない1対1のリングバッファ ====
+    // 書くのは相手のゲームを動かすワーカー、読むのは自分のゲームを動かすワーカーだけ
+    template <class T, int N>
+    class SpscQueue {
+    public:
+        static_assert((N & (N - 1)) == 0, "capacity must be a power of two");
+
+        bool push(const T& item) {
+            std::uint32_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N) return false; // いっぱい
+            items[t & (N - 1)] = item;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+        // 先頭を見るだけ（空なら false）
+        bool peek(T& item) const {
+            std::uint32_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return false;
+            item = items[h & (N - 1)];
+            return true;
+        }
+        void pop() { head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+        // 両方のワーカーが止まっているときだけ呼ぶこと
+        void clear() { head.store(tail.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+    private:
+        std::array<T, N> items{};
+        std::atomic<std::uint32_t> head{ 0 };
+        std::atomic<std::uint32_t> tail{ 0 };
+    };
+
+    // 相手に送る攻撃1回分
+    struct GarbagePacket {
+        std::uint32_t tick;                  // 送ったティック
+        std::uint16_t lines;
+    };
+
+    // ==== 1つのゲーム ====
+    // 毎ティック触るもの（キュー・受け取ったガベージ・次に置く時刻）を前にまとめる
+    struct alignas(64) Instance {
+        SpscQueue<GarbagePacket, 16> incoming;  // 相手から届いた攻撃
+        int pending = 0;                     // 受け取ったが、まだせり上げていないガベージの段数
+        int opponent = 0;                    // 相手の番号
+        int moveCredit = 0;                  // 1ティックごとに PPS を足し、TICKS_PER_SECOND たまったら1個置く
+        std::uint32_t started = 0;           // 対戦を始めたティック
+        std::uint32_t holeState = 1;         // ガベージの穴の列を決める乱数（xorshift32）
+        std::uint32_t sent = 0;              // この対戦で送った攻撃の合計
+        Simulation sim;
+
+        int nextHole() {
+            holeState ^= holeState << 13;
+            holeState ^= holeState >> 17;
+            holeState ^= holeState << 5;
+            return static_cast<int>(holeState % Board::WIDTH);
+        }
+    };
+
+    // ==== 時間の分布（2のべき乗ごとの区間を、さらに4つに分けて数える） ====
+    struct LatencyHistogram {
+        static const int SUB = 4;
+        std::array<std::uint64_t, 64 * SUB> counts{};
+        std::uint64_t total = 0;
+        std::uint64_t maxNanos = 0;
+
+        static int bucketOf(std::uint64_t nanos) {
+            if (nanos < SUB) return static_cast<int>(nanos);
+            int log = 0;
+            while ((nanos >> (log + 1)) != 0) ++log;
+            int sub = static_cast<int>((nanos >> (log - 2)) & (SUB - 1));
+            return log * SUB + sub;
+        }
+        // 区間の上端（この区間に入る一番大きい値）
+        static std::uint64_t upperOf(int bucket) {
+            if (bucket < SUB) return static_cast<std::uint64_t>(bucket);
+            int log = bucket / SUB, sub = bucket % SUB;
+            return ((static_cast<std::uint64_t>(SUB + sub + 1)) << (log - 2)) - 1;
+        }
+        void add(std::uint64_t nanos) {
+            ++counts[bucketOf(nanos)];
+            ++total;
+            if (nanos > maxNanos) maxNanos = nanos;
+        }
+        void merge(const LatencyHistogram& other) {
+            for (std::size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+            total += other.total;
+            maxNanos = std::max(maxNanos, other.maxNanos);
+        }
+        std::uint64_t percentile(double percent) const {
+            std::uint64_t rank = static_cast<std::uint64_t>(percent / 100.0 * total);
+            std::uint64_t seen = 0;
+            for (int i = 0; i < static_cast<int>(counts.size()); ++i) {
+                seen += counts[i];
+                if (seen > rank) return std::min(upperOf(i), maxNanos);
+            }
+            return maxNanos;
+        }
+    };
+
+    // ワーカーごとの道具と集計（別のワーカーと同じキャッシュラインに乗らないようにする）
+    struct alignas(64) WorkerState {
+        BeamBot bot;
+        LatencyHistogram latency;
+        std::uint64_t pieces = 0;
+        std::uint64_t garbageLines = 0;
+    };
+
+    class MatchHost {
+    public:
+        MatchHost(int gameCount, int piecesPerSecond, unsigned threads, std::uint32_t seed)
+            : pool(threads), games(gameCount),
+              piecesPerSecond(std::min(TICKS_PER_SECOND, std::max(1, piecesPerSecond))), hostSeed(seed) {
+            for (unsigned w = 0; w < pool.size(); ++w) {
+                workers.push_back(std::make_unique<WorkerState>());
+                BeamBot& bot = workers.back()->bot;
+                bot.budget = std::chrono::hours(1); // 時間では打ち切らない
+                bot.initialWidth = bot.maxWidth = BOT_WIDTH;
+                bot.maxDepth = BOT_DEPTH;
+            }
+            int half = gameCount / 2;
+            for (int i = 0; i < half; ++i) startMatch(i, i + half);
+        }
+
+        // 全部のゲームを1ティック進める（BATCH 個ずつタスクにして、全部終わるまで待つ）
+        void step() {
+            for (int first = 0; first < static_cast<int>(games.size()); first += BATCH) {
+                int last = std::min(first + BATCH, static_cast<int>(games.size()));
+                pool.submit([this, first, last] { runBatch(first, last); });
+            }
+            pool.wait();
+            finishMatches();
+            ++tick;
+        }
+
+        unsigned threadCount() const { return pool.size(); }
+        std::uint64_t matchesPlayed() const { return matches; }
+        std::uint64_t drawsPlayed() const { return draws; }
+
+        // ワーカーごとの集計をまとめる
+        void summarize(LatencyHistogram& latency, std::uint64_t& pieces, std::uint64_t& garbage) const {
+            for (const auto& w : workers) {
+                latency.merge(w->latency);
+                pieces += w->pieces;
+                garbage += w->garbageLines;
+            }
+        }
+
+    private:
+        ThreadPool pool;
+        std::vector<Instance> games;
+        std::vector<std::unique_ptr<WorkerState>> workers;
+        int piecesPerSecond;                 // 1ティックに1個までなので TICKS_PER_SECOND まで
+        std::uint32_t hostSeed;
+        std::uint32_t tick = 0;
+        std::uint64_t matches = 0;           // 終わった対戦の数
+        std::uint64_t draws = 0;             // そのうち時間切れの数
+        std::uint64_t matchSerial = 0;       // 対戦ごとのシードの番号
+
+        void startMatch(int a, int b) {
+            std::seed_seq seq{ hostSeed, static_cast<std::uint32_t>(matchSerial), static_cast<std::uint32_t>(matchSerial >> 32) };
+            ++matchSerial;
+            std::array<std::uint32_t, 3> seeds;
+            seq.generate(seeds.begin(), seeds.end());
+            // 同じ組の2人には同じ順番でピースが来るようにする
+            for (int i : { a, b }) {
+                Instance& g = games[i];
+                g.sim.reset(seeds[0]);
+                g.incoming.clear();
+                g.pending = 0;
+                g.sent = 0;
+                g.moveCredit = TICKS_PER_SECOND - piecesPerSecond; // 次のティックで最初の1個を置く
+                g.started = tick;
+                g.holeState = (i == a ? seeds[1] : seeds[2]) | 1u;
+                g.opponent = i == a ? b : a;
+            }
+        }
+
+        // ゲーム first～last-1 を1ティック進める（ワーカーの中で呼ばれる）
+        void runBatch(int first, int last) {
+            WorkerState& w = *workers[std::max(0, pool.currentWorker())];
+            for (int i = first; i < last; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                Instance& g = games[i];
+                if (g.sim.isGameOver()) continue; // 相手と一緒にやり直すのを待つ
+
+                // 前のティックまでに届いた攻撃を受け取る
+                GarbagePacket packet;
+                while (g.incoming.peek(packet) && packet.tick < tick) {
+                    g.pending += packet.lines;
+                    g.incoming.pop();
+                }
+
+                // 置く間隔を整数のティックに丸めると PPS がずれる（60 / 7 = 8 ティックなら 7.5 PPS）ので、
+                // 余りを持ち越して、平均がちょうど PPS になるようにする
+                g.moveCredit += piecesPerSecond;
+                if (g.moveCredit >= TICKS_PER_SECOND) {
+                    g.moveCredit -= TICKS_PER_SECOND;
+                    if (w.bot.play(g.sim)) {
+                        ++w.pieces;
+                        const LockResult& lock = g.sim.lastLock();
+                        int attack = attackOf(lock);
+                        if (lock.linesCleared > 0) {
+                            // 消したときは、届いているガベージと相殺する
+                            int cancel = std::min(attack, g.pending);
+                            g.pending -= cancel;
+                            attack -= cancel;
+                        }
+                        else if (g.pending > 0) {
+                            w.garbageLines += static_cast<std::uint64_t>(g.pending);
+                            g.sim.addGarbage(g.pending, g.nextHole());
+                            g.pending = 0;
+                        }
+                        // 相手のキューがいっぱいなら捨てる（毎ティック取り出すので、ふつうはあふれない）
+                        if (attack > 0 && games[g.opponent].incoming.push(GarbagePacket{ tick, static_cast<std::uint16_t>(attack) }))
+                            g.sent += static_cast<std::uint32_t>(attack);
+                    }
+                    else {
+                        g.sim.topOut(); // 置ける場所がなければ負け
+                    }
+                }
+                g.sim.tick();
+                w.latency.add(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+            }
+        }
+
+        // どちらかがゲームオーバーになった組をやり直す（ワーカーが止まっているときに呼ぶ）
+        void finishMatches() {
+            int half = static_cast<int>(games.size()) / 2;
+            for (int a = 0; a < half; ++a) {
+                int b = games[a].opponent;
+                bool decided = games[a].sim.isGameOver() || games[b].sim.isGameOver();
+                bool timeUp = tick + 1 - games[a].started >= static_cast<std::uint32_t>(MATCH_SECONDS * TICKS_PER_SECOND);
+                if (decided || timeUp) {
+                    ++matches;
+                    if (!decided) ++draws;
+                    startMatch(a, b);
+                }
+            }
+        }
+    };
+}
+
+int main(int argc, char** argv) {
+    int gameCount = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 60;
+    int pps = argc > 3 ? std::atoi(argv[3]) : 2;
+    unsigned threads = argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 0;
+    std::uint32_t seed = argc > 5 ? static_cast<std::uint32_t>(std::strtoul(argv[5], nullptr, 10)) : 1u;
+    gameCount = std::max(2, gameCount & ~1);
+
+    MatchHost host(gameCount, pps, threads, seed);
+    const long long ticks = static_cast<long long>(seconds) * TICKS_PER_SECOND;
+    std::printf("%d games (%zu bytes each), %lld ticks, %d pieces/s, %u threads\n", gameCount, sizeof(Instance), ticks,
+                pps, host.threadCount());
+
+    auto start = std::chrono::steady_clock::now();
+    for (long long t = 0; t < ticks; ++t) host.step();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LatencyHistogram latency;
+    std::uint64_t pieces = 0, garbage = 0;
+    host.summarize(latency, pieces, garbage);
+    double cores = static_cast<double>(host.threadCount());
+    double gameSeconds = static_cast<double>(gameCount) * seconds; // 全部のゲームで進めたゲーム内の時間
+
+    std::printf("time: %.3f s (%.1fx real time), matches: %llu (%llu draws), pieces: %llu, garbage lines: %llu\n",
+                elapsed, seconds / elapsed, static_cast<unsigned long long>(host.matchesPlayed()),
+                static_cast<unsigned long long>(host.drawsPlayed()), static_cast<unsigned long long>(pieces),
+                static_cast<unsigned long long>(garbage));
+    // 1コアで実時間のまま動かし続けられるゲーム数・1秒あたりに終わる対戦の数・進められるティック数
+    std::printf("per core: %.0f real-time games, %.2f matches/s, %.0f game ticks/s\n", gameSeconds / elapsed / cores,
+                host.matchesPlayed() / elapsed / cores, gameCount * static_cast<double>(ticks) / elapsed / cores);
+    std::printf("tick latency per game (us): p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n",
+                latency.percentile(50) / 1000.0, latency.percentile(90) / 1000.0, latency.percentile(99) / 1000.0,
+                latency.percentile(99.9) / 1000.0, latency.maxNanos / 1000.0);
+    return 0;
+}
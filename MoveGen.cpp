@@ -0,0 +1,311 @@
+#include "MoveGen.hpp"
+#include "Collision.hpp"
+#include "Piece.hpp"
+#include <vector>
+
+namespace {
+    // 同じマスを埋める回転状態をまとめるための表
+    // CANONICAL[種類][回転] = 形（行マスク）が同じになる一番小さい回転状態と、そのときの位置のずれ
+    struct Canonical {
+        int rotation;
+        int dx, dy;
+    };
+
+    constexpr std::array<std::array<Canonical, 4>, 7> buildCanonical() {
+        std::array<std::array<Canonical, 4>, 7> table{};
+        for (int t = 0; t < 7; ++t)
+            for (int r = 0; r < 4; ++r) {
+                const Orientation& o = ORIENTATIONS[t][r];
+                for (int c = 0; c <= r; ++c) {
+                    const Orientation& base = ORIENTATIONS[t][c];
+                    bool same = base.height == o.height;
+                    for (int i = 0; i < 4 && same; ++i) same = base.rowMasks[i] == o.rowMasks[i];
+                    if (same) {
+                        table[t][r] = Canonical{ c, o.minX - base.minX, o.minY - base.minY };
+                        break;
+                    }
+                }
+            }
+        return table;
+    }
+
+    constexpr auto CANONICAL = buildCanonical();
+
+    // Tミノの「とがっている側」（Spawn状態の (0,1) を回転させた向き）
+    constexpr Cell T_STEM[4] = { {0,1}, {-1,0}, {0,-1}, {1,0} };
+
+    // SRSのキックの5番目（Tスピントリプルなどで使う大きなキック）はミニではなく通常のTスピンにする
+    const int LAST_KICK = 4;
+
+    inline bool testBit(const std::uint64_t* bits, int i) { return (bits[i >> 6] >> (i & 63)) & 1u; }
+    inline void setBit(std::uint64_t* bits, int i) { bits[i >> 6] |= 1ull << (i & 63); }
+
+    // 回転して (x, y) に着地したときの回転入れの種類
+    Spin detectSpin(const Board& board, PieceType type, Rotation rot, int x, int y, int kickIndex) {
+        if (type == PieceType::T) {
+            // 3コーナールール：中心の斜め4マスのうち3マス以上が埋まっていればTスピン
+            const Cell& stem = T_STEM[static_cast<int>(rot)];
+            int corners = 0, front = 0;
+            for (int cy = -1; cy <= 1; cy += 2)
+                for (int cx = -1; cx <= 1; cx += 2) {
+                    if (!board.isOccupied(x + cx, y + cy)) continue;
+                    ++corners;
+                    if (cx * stem.x + cy * stem.y == 1) ++front; // とがっている側の2マス
+                }
+            if (corners < 3) return Spin::None;
+            return (front == 2 || kickIndex == LAST_KICK) ? Spin::Full : Spin::Mini;
+        }
+        // Tミノ以外：左右にも上にも動けない位置への回転入れ
+        const Orientation& o = orientationOf(type, rot);
+        if (!board.fits(o, x - 1, y) && !board.fits(o, x + 1, y) && !board.fits(o, x, y - 1))
+            return Spin::Mini;
+        return Spin::None;
+    }
+}
+
+// 回転状態・列ごとに、ピースを置ける y をビット列にまとめる（CollisionField で全部の y を一度に調べる）
+void MoveGenerator::buildFitMap(const Board& board, PieceType type) {
+    static_assert(X_OFFSET == CollisionField::X_OFFSET && X_RANGE == CollisionField::X_RANGE &&
+                  Y_OFFSET == CollisionField::Y_OFFSET && Y_RANGE == CollisionField::Y_RANGE,
+                  "MoveGenerator and CollisionField must use the same position range");
+    CollisionField field(board);
+    for (int r = 0; r < 4; ++r) field.fitColumns(orientationOf(type, static_cast<Rotation>(r)), fitMap[r]);
+}
+
+// 出現位置からの幅優先探索で、到達できる着地位置をすべて列挙する
+int MoveGenerator::generate(const Board& board, PieceType type, Placement* out) {
+    visited.fill(0);
+    placed.fill(0);
+    buildFitMap(board, type);
+
+    const int t = static_cast<int>(type);
+    auto index = stateIndex;
+
+    int head = 0, tail = 0;
+    // 未到達の状態ならキューに積む
+    auto visit = [&](int x, int y, int r) {
+        if (!inRange(x, y)) return;
+        int i = index(x, y, r);
+        if (testBit(visited.data(), i)) return;
+        setBit(visited.data(), i);
+        spinOf[i] = static_cast<std::uint8_t>(Spin::None);
+        queue[tail++] = static_cast<std::uint16_t>(i);
+    };
+
+    // 出現位置に置けなければ何もできない
+    if (!board.fits(orientationOf(type, Rotation::Spawn), SPAWN_X, SPAWN_Y)) return 0;
+
+    // 盤面の上側の空っぽの行の中では、出現位置から回転・左右移動・落下でどの状態にも行ける
+    // （どの形も y=0 なら2段目までに収まるので、3行以上空いていれば出現位置で回転できる）
+    // その範囲の状態はまとめて到達済みにし、範囲の外へつながる状態だけをキューに積む
+    int openRows = 0;
+    while (openRows < Board::HEIGHT && board.rows[openRows] == 0) ++openRows;
+    if (openRows >= 3) {
+        int sky[4];     // 回転状態ごとの、空の行に収まる一番下の y
+        for (int r = 0; r < 4; ++r) sky[r] = openRows - 1 - ORIENTATIONS[t][r].maxY;
+        for (int r = 0; r < 4; ++r)
+            for (int x = -X_OFFSET; x < X_RANGE - X_OFFSET; ++x) {
+                if (!fits(r, x, sky[r])) continue; // 壁にはみ出す列
+                for (int y = 0; y <= sky[r]; ++y) {
+                    int i = index(x, y, r);
+                    setBit(visited.data(), i);
+                    spinOf[i] = static_cast<std::uint8_t>(Spin::None);
+                    // 一番下（ここから先へ落ちられる）と、回転すると範囲の外に出る・キックが必要な状態だけ調べる
+                    bool expand = y == sky[r];
+                    for (int dir = 0; dir < 2 && !expand; ++dir) {
+                        int rt = static_cast<int>(rotatedState(static_cast<Rotation>(r), dir));
+                        expand = y > sky[rt] || !fits(rt, x, y);
+                    }
+                    if (expand) queue[tail++] = static_cast<std::uint16_t>(i);
+                }
+            }
+    }
+    else {
+        visit(SPAWN_X, SPAWN_Y, 0);
+    }
+
+    while (head < tail) {
+        int i = queue[head++];
+        int x = i % X_RANGE - X_OFFSET;
+        int y = (i / X_RANGE) % Y_RANGE - Y_OFFSET;
+        int r = i / (X_RANGE * Y_RANGE);
+
+        // 左右移動・ソフトドロップ
+        if (inRange(x - 1, y) && fits(r, x - 1, y)) visit(x - 1, y, r);
+        if (inRange(x + 1, y) && fits(r, x + 1, y)) visit(x + 1, y, r);
+        if (inRange(x, y + 1) && fits(r, x, y + 1)) visit(x, y + 1, r);
+
+        // 回転（Piece::rotate と同じく、最初に置けたキックで確定する）
+        for (int dir = 0; dir < 2; ++dir) {
+            Rotation from = static_cast<Rotation>(r);
+            Rotation to = rotatedState(from, dir);
+            const int rt = static_cast<int>(to);
+            const auto& kicks = kicksOf(type, from, dir);
+            for (int k = 0; k < 5; ++k) {
+                int nx = x + kicks[k].x, ny = y + kicks[k].y;
+                // 範囲外の位置（盤面のずっと上など）は、盤面で直接判定する
+                bool inside = inRange(nx, ny);
+                if (inside ? !fits(rt, nx, ny) : !board.fits(orientationOf(type, to), nx, ny)) continue;
+                // 回転してそのまま着地できるなら、回転入れかどうかを記録しておく
+                if (inside && !fits(rt, nx, ny + 1)) {
+                    Spin spin = detectSpin(board, type, to, nx, ny, k);
+                    visit(nx, ny, rt);
+                    int j = index(nx, ny, rt);
+                    if (static_cast<std::uint8_t>(spin) > spinOf[j]) spinOf[j] = static_cast<std::uint8_t>(spin);
+                }
+                else {
+                    visit(nx, ny, rt);
+                }
+                break;
+            }
+        }
+    }
+
+    // 着地できる状態を、同じマスを埋めるものは1つにまとめて出力する
+    int count = 0;
+    for (int q = 0; q < tail && count < MAX_PLACEMENTS; ++q) {
+        int i = queue[q];
+        int x = i % X_RANGE - X_OFFSET;
+        int y = (i / X_RANGE) % Y_RANGE - Y_OFFSET;
+        int r = i / (X_RANGE * Y_RANGE);
+        if (fits(r, x, y + 1)) continue; // まだ落ちられる
+
+        const Canonical& c = CANONICAL[t][r];
+        int canon = index(x + c.dx, y + c.dy, c.rotation);
+        if (testBit(placed.data(), canon)) {
+            // 既に出力した置き方と同じマス：回転入れの情報だけ引き継ぐ
+            for (int k = 0; k < count; ++k) {
+                const Placement& p = out[k];
+                const Canonical& pc = CANONICAL[t][static_cast<int>(p.rotation)];
+                if (index(p.x + pc.dx, p.y + pc.dy, pc.rotation) == canon) {
+                    if (spinOf[i] > static_cast<std::uint8_t>(p.spin)) out[k].spin = static_cast<Spin>(spinOf[i]);
+                    break;
+                }
+            }
+            continue;
+        }
+        setBit(placed.data(), canon);
+        out[count++] = Placement{ type, static_cast<Rotation>(r), x, y, false, static_cast<Spin>(spinOf[i]) };
+    }
+    return count;
+}
+
+// 置き方 target まで動かす操作の列（回転入れの置き方は、まず回転で着地する列を探す）
+int MoveGenerator::findPath(const Board& board, const Placement& target, Action* out) {
+    int n = -1;
+    if (target.spin != Spin::None) n = searchPath(board, target, true, out);
+    if (n < 0) n = searchPath(board, target, false, out);
+    return n;
+}
+
+// 出現位置からの幅優先探索で、各状態に「どの状態から、どの操作で来たか」を記録し、
+// target と同じマスに着地できる状態が見つかったら、そこから出現位置までたどって操作の列を作る
+int MoveGenerator::searchPath(const Board& board, const Placement& target, bool requireSpin, Action* out) {
+    const PieceType type = target.type;
+    const int t = static_cast<int>(type);
+    if (!board.fits(orientationOf(type, Rotation::Spawn), SPAWN_X, SPAWN_Y)) return -1;
+    visited.fill(0);
+    buildFitMap(board, type);
+
+    // 同じマスを埋める置き方は、CANONICAL でそろえた番号で比べる
+    auto canonicalIndex = [&](int x, int y, int r) {
+        const Canonical& c = CANONICAL[t][r];
+        return stateIndex(x + c.dx, y + c.dy, c.rotation);
+    };
+    const int goal = canonicalIndex(target.x, target.y, static_cast<int>(target.rotation));
+
+    int head = 0, tail = 0;
+    int start = stateIndex(SPAWN_X, SPAWN_Y, 0);
+    setBit(visited.data(), start);
+    parent[start] = static_cast<std::uint16_t>(start);
+    queue[tail++] = static_cast<std::uint16_t>(start);
+
+    int found = -1;                 // 最後の状態（ここから HardDrop する）
+    Action lastMove = Action::None; // 回転入れのときの最後の回転（found からの操作）
+    auto visit = [&](int from, int x, int y, int r, Action move) {
+        int i = stateIndex(x, y, r);
+        if (testBit(visited.data(), i)) return;
+        setBit(visited.data(), i);
+        parent[i] = static_cast<std::uint16_t>(from);
+        moveOf[i] = move;
+        queue[tail++] = static_cast<std::uint16_t>(i);
+    };
+
+    while (head < tail && found < 0) {
+        int i = queue[head++];
+        int x = i % X_RANGE - X_OFFSET;
+        int y = (i / X_RANGE) % Y_RANGE - Y_OFFSET;
+        int r = i / (X_RANGE * Y_RANGE);
+
+        // ここからハードドロップして target に着地するなら終わり
+        if (!requireSpin && canonicalIndex(x, y + CollisionField::dropDistance(fitMap[r], x, y), r) == goal) {
+            found = i;
+            break;
+        }
+
+        if (inRange(x - 1, y) && fits(r, x - 1, y)) visit(i, x - 1, y, r, Action::MoveLeft);
+        if (inRange(x + 1, y) && fits(r, x + 1, y)) visit(i, x + 1, y, r, Action::MoveRight);
+        if (inRange(x, y + 1) && fits(r, x, y + 1)) visit(i, x, y + 1, r, Action::SoftDrop);
+
+        for (int dir = 0; dir < 2 && found < 0; ++dir) {
+            Rotation from = static_cast<Rotation>(r);
+            Rotation to = rotatedState(from, dir);
+            const int rt = static_cast<int>(to);
+            const auto& kicks = kicksOf(type, from, dir);
+            Action move = dir == ROTATE_CW ? Action::RotateCW : Action::RotateCCW;
+            for (int k = 0; k < 5; ++k) {
+                int nx = x + kicks[k].x, ny = y + kicks[k].y;
+                bool inside = inRange(nx, ny);
+                if (inside ? !fits(rt, nx, ny) : !board.fits(orientationOf(type, to), nx, ny)) continue;
+                if (!inside) break; // 範囲外の状態は generate でも使わない
+                // 回転入れ：回転してそのまま target に着地し、回転入れと判定されれば終わり
+                if (requireSpin && !fits(rt, nx, ny + 1) && canonicalIndex(nx, ny, rt) == goal &&
+                    static_cast<int>(detectSpin(board, type, to, nx, ny, k)) >= static_cast<int>(target.spin)) {
+                    found = i;
+                    lastMove = move;
+                    break;
+                }
+                visit(i, nx, ny, rt, move);
+                break;
+            }
+        }
+    }
+    if (found < 0) return -1;
+
+    // 出現位置までの長さを数えてから、後ろから書き込む
+    int length = (target.hold ? 1 : 0) + (lastMove != Action::None ? 1 : 0) + 1;
+    for (int i = found; i != start; i = parent[i]) ++length;
+    if (length > MAX_PATH) return -1;
+
+    int pos = length;
+    out[--pos] = Action::HardDrop;
+    if (lastMove != Action::None) out[--pos] = lastMove;
+    for (int i = found; i != start; i = parent[i]) out[--pos] = moveOf[i];
+    if (target.hold) out[--pos] = Action::Hold;
+    return length;
+}
+
+// queue の先頭から depth 個のピースを置いていったときの末端の局面数
+// 盤面は1つだけ使い、make / unmake で進めて戻す
+static std::uint64_t perftFrom(Board& board, const PieceType* queue, int depth) {
+    if (depth == 0) return 1;
+
+    MoveGenerator gen;
+    std::vector<Placement> list(MoveGenerator::MAX_PLACEMENTS);
+    int n = gen.generate(board, queue[0], list.data());
+    if (depth == 1) return static_cast<std::uint64_t>(n);
+
+    std::uint64_t total = 0;
+    Board::UndoRecord undo;
+    for (int i = 0; i < n; ++i) {
+        board.make(list[i].type, list[i].rotation, list[i].x, list[i].y, undo);
+        total += perftFrom(board, queue + 1, depth - 1);
+        board.unmake(undo);
+    }
+    return total;
+}
+
+std::uint64_t perft(const Board& board, const PieceType* queue, int depth) {
+    Board work = board;
+    return perftFrom(work, queue, depth);
+}
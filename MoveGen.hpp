@@ -0,0 +1,92 @@
+#pragma once
+#include "Action.hpp"
+#include "Board.hpp"
+#include "PieceTable.hpp"
+#include <array>
+#include <cstdint>
+
+// ==== 置き場所の列挙（手生成） ====
+// 出現位置 (x=3, y=0) から、左右移動・ソフトドロップ・回転（SRSのキック込み）で
+// 到達できる着地位置をすべて列挙する
+// Piece::canMove / Piece::rotate と同じ判定を使うので、ゲーム中に実際に置ける場所と一致する
+// findPath で、列挙した置き方まで実際にピースを動かす操作（Action）の列も求められる（Botが使う）
+
+// 回転入れの種類
+enum class Spin : std::uint8_t {
+    None,   // 回転入れではない
+    Mini,   // Tスピンミニ（Tミノ以外は、動けない位置への回転入れをここに含める）
+    Full    // Tスピン
+};
+
+// 1手分の置き方
+struct Placement {
+    PieceType type;                 // 置いたピースの種類
+    Rotation rotation;              // 置いたときの回転状態
+    int x, y;                       // 置いたときの位置（Piece::x, Piece::y と同じ基準）
+    bool hold = false;              // このピースを置く前にホールドを使ったか
+    Spin spin = Spin::None;         // 最後の操作が回転入れだったか
+};
+
+class MoveGenerator {
+public:
+    // 1種類のピースで列挙される置き方の最大数
+    // （4回転 × 16列 × 1列あたりの着地位置の最大数。実際にはずっと少ない）
+    static const int MAX_PLACEMENTS = 4 * 16 * 16;
+
+    // 出現位置
+    static const int SPAWN_X = 3;
+    static const int SPAWN_Y = 0;
+
+    // board 上で type のピースが到達できる着地位置を out に書き込み、その数を返す
+    // ・同じマスを埋める置き方（S/Z/I/O の対称な回転状態など）は1つにまとめる
+    // ・回転入れで置ける場合は spin にその種類を入れる（通常の置き方とは別に数えない）
+    // out は MAX_PLACEMENTS 個以上の配列を渡すこと。メモリ確保は行わない
+    int generate(const Board& board, PieceType type, Placement* out);
+
+    // 操作の列の最大の長さ（ホールドとハードドロップを含む）
+    static const int MAX_PATH = 128;
+
+    // 出現位置から target の置き方まで動かす操作を out に書き込み、その数を返す（置けなければ -1）
+    // ・幅優先探索なので、操作の数が一番少ない列になる。最後は必ず HardDrop
+    // ・target.hold なら先頭に Hold を入れる（board はホールドの前後で変わらないのでそのまま使う）
+    // ・target.spin が回転入れなら、できるだけ最後の操作が回転になる列を選ぶ
+    // out は MAX_PATH 個以上の配列を渡すこと
+    int findPath(const Board& board, const Placement& target, Action* out);
+
+private:
+    // 探索する状態 (x, y, 回転) を1つの番号にまとめる
+    // x は -2..13、y は -4..27 の範囲だけを扱う（それ以外に置ける形はない）
+    // （CollisionField と同じ範囲）
+    static const int X_OFFSET = 2, X_RANGE = 16;
+    static const int Y_OFFSET = 4, Y_RANGE = 32;
+    static const int STATE_COUNT = 4 * Y_RANGE * X_RANGE;
+
+    // fitMap[回転][x + X_OFFSET] のビット (y + Y_OFFSET) が立っていれば、その位置にピースを置ける
+    // 探索の前に1回だけ作っておき、探索中の当たり判定はビットを見るだけにする
+    std::array<std::array<std::uint32_t, X_RANGE>, 4> fitMap;
+
+    // 状態ごとの到達済みフラグ・着地位置の重複チェック（ビットセット）
+    std::array<std::uint64_t, STATE_COUNT / 64> visited;
+    std::array<std::uint64_t, STATE_COUNT / 64> placed;
+    std::array<std::uint8_t, STATE_COUNT> spinOf;     // 回転入れで着地できる場合の種類
+    std::array<std::uint16_t, STATE_COUNT> queue;     // 幅優先探索のキュー
+    std::array<std::uint16_t, STATE_COUNT> parent;    // findPath：1つ前の状態
+    std::array<Action, STATE_COUNT> moveOf;           // findPath：1つ前の状態からの操作
+
+    static int stateIndex(int x, int y, int r) {
+        return (r * Y_RANGE + (y + Y_OFFSET)) * X_RANGE + (x + X_OFFSET);
+    }
+    static bool inRange(int x, int y) {
+        return x + X_OFFSET >= 0 && x + X_OFFSET < X_RANGE && y + Y_OFFSET >= 0 && y + Y_OFFSET < Y_RANGE;
+    }
+
+    void buildFitMap(const Board& board, PieceType type);
+    // findPath の本体（requireSpin なら、回転で target に着地する列だけを探す）
+    int searchPath(const Board& board, const Placement& target, bool requireSpin, Action* out);
+    bool fits(int r, int x, int y) const {
+        return (fitMap[r][x + X_OFFSET] >> (y + Y_OFFSET)) & 1u;
+    }
+};
+
+// 正しさの確認用：queue の先頭から depth 個のピースを順に置いていったときの末端の局面数（ホールドなし）
+std::uint64_t perft(const Board& board, const PieceType* queue, int depth);
@@ -0,0 +1,188 @@
+#include "PcDatabase.hpp"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[4] = { 'P', 'C', 'D', 'B' };
+
+    // キー2つからバケットの位置を決めるハッシュ（splitmix64 の混ぜ方）
+    std::uint64_t bucketHash(std::uint64_t fieldKey, std::uint64_t queueKey) {
+        std::uint64_t z = fieldKey ^ (queueKey * 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+}
+
+// ==================== キーと手順の変換 ====================
+// 盤面のキー：下位4ビットが段数、その上に下の行から順に10ビットずつ
+// ホールドとネクストのキー：下位3ビットがホールド（0 = なし、1～7 = 種類 + 1）、次の5ビットがピース数、
+//                          その上に現在のピースから順に3ビットずつ
+bool PcDatabase::makeKey(const PcProblem& problem, std::uint64_t& fieldKey, std::uint64_t& queueKey) {
+    if (problem.height <= 0 || problem.height > MAX_HEIGHT) return false;
+    if (1 + problem.queue.size() > static_cast<std::size_t>(MAX_QUEUE)) return false;
+    for (int y = 0; y < Board::HEIGHT - problem.height; ++y)
+        if (problem.field.rows[y] != 0) return false;
+
+    fieldKey = static_cast<std::uint64_t>(problem.height);
+    for (int r = 0; r < problem.height; ++r)
+        fieldKey |= static_cast<std::uint64_t>(problem.field.rows[Board::HEIGHT - 1 - r]) << (4 + Board::WIDTH * r);
+
+    queueKey = problem.hold ? 1 + static_cast<std::uint64_t>(*problem.hold) : 0;
+    queueKey |= static_cast<std::uint64_t>(1 + problem.queue.size()) << 3;
+    queueKey |= static_cast<std::uint64_t>(problem.current) << 8;
+    for (std::size_t i = 0; i < problem.queue.size(); ++i)
+        queueKey |= static_cast<std::uint64_t>(problem.queue[i]) << (11 + 3 * i);
+    return true;
+}
+
+// 1手を16ビットにする：種類(3) | 回転(2) | x + 2 (4) | 床からの高さ + 4 (5) | ホールド(1)
+// y は盤面の高さによらないように、一番下の行からの距離で持つ
+std::uint16_t PcDatabase::encodeMove(const Placement& p) {
+    int fromBottom = Board::HEIGHT - 1 - p.y + 4;
+    return static_cast<std::uint16_t>(static_cast<int>(p.type)
+                                    | static_cast<int>(p.rotation) << 3
+                                    | (p.x + 2) << 5
+                                    | fromBottom << 9
+                                    | (p.hold ? 1 : 0) << 14);
+}
+
+Placement PcDatabase::decodeMove(std::uint16_t code) {
+    Placement p;
+    p.type = static_cast<PieceType>(code & 7);
+    p.rotation = static_cast<Rotation>((code >> 3) & 3);
+    p.x = ((code >> 5) & 15) - 2;
+    p.y = Board::HEIGHT - 1 - (((code >> 9) & 31) - 4);
+    p.hold = ((code >> 14) & 1) != 0;
+    return p;
+}
+
+// ==================== PcDatabase クラス ====================
+PcDatabase::~PcDatabase() {
+    close();
+}
+
+bool PcDatabase::open(const char* path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(PcDbHeader))) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = map ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (map) CloseHandle(map);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = map;
+    mapping = view;
+    mappedBytes = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PcDbHeader))) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // マップした後はファイルを閉じてもよい
+    if (view == MAP_FAILED) return false;
+    mapping = view;
+    mappedBytes = static_cast<std::size_t>(st.st_size);
+#endif
+
+    // ヘッダとファイルの大きさを確かめる
+    const PcDbHeader* h = static_cast<const PcDbHeader*>(mapping);
+    bool valid = std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) == 0 && h->version == VERSION
+              && h->bucketCount != 0 && (h->bucketCount & (h->bucketCount - 1)) == 0
+              && h->bucketCount <= (mappedBytes - sizeof(PcDbHeader)) / sizeof(PcDbEntry);
+    if (!valid) {
+        close();
+        return false;
+    }
+    header = h;
+    entries = reinterpret_cast<const PcDbEntry*>(static_cast<const char*>(mapping) + sizeof(PcDbHeader));
+    return true;
+}
+
+void PcDatabase::close() {
+    if (mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+        CloseHandle(static_cast<HANDLE>(mappingHandle));
+        CloseHandle(static_cast<HANDLE>(fileHandle));
+        mappingHandle = fileHandle = nullptr;
+#else
+        munmap(mapping, mappedBytes);
+#endif
+    }
+    mapping = nullptr;
+    mappedBytes = 0;
+    header = nullptr;
+    entries = nullptr;
+}
+
+// ハッシュの位置から順に、同じキーか空きバケットが見つかるまで見る（マップしたメモリを直接読むだけ）
+bool PcDatabase::lookup(const PcProblem& problem, PcDbAnswer& answer) const {
+    if (!entries) return false;
+    std::uint64_t fieldKey, queueKey;
+    if (!makeKey(problem, fieldKey, queueKey)) return false;
+
+    std::uint64_t mask = header->bucketCount - 1;
+    for (std::uint64_t i = bucketHash(fieldKey, queueKey) & mask;; i = (i + 1) & mask) {
+        const PcDbEntry& e = entries[i];
+        if (!e.used) return false;
+        if (e.fieldKey != fieldKey || e.queueKey != queueKey) continue;
+
+        answer.solvable = e.solvable != 0;
+        answer.solution.clear();
+        for (int m = 0; m < e.length && m < PcDbEntry::MAX_SOLUTION; ++m)
+            answer.solution.push_back(decodeMove(e.moves[m]));
+        return true;
+    }
+}
+
+// バケットの数を件数の2倍以上の2のべき乗にして（空きバケットで探索が必ず止まるように）、ハッシュ表を作って書く
+bool PcDatabase::write(const char* path, const std::vector<PcDbEntry>& list) {
+    std::uint64_t buckets = 16;
+    while (buckets < list.size() * 2) buckets *= 2;
+
+    std::vector<PcDbEntry> table(static_cast<std::size_t>(buckets));
+    std::memset(table.data(), 0, table.size() * sizeof(PcDbEntry));
+    for (const PcDbEntry& e : list) {
+        std::uint64_t i = bucketHash(e.fieldKey, e.queueKey) & (buckets - 1);
+        while (table[i].used) i = (i + 1) & (buckets - 1);
+        table[i] = e;
+        table[i].used = 1;
+    }
+
+    PcDbHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.bucketCount = buckets;
+    h.entryCount = list.size();
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, file) == 1
+           && std::fwrite(table.data(), sizeof(PcDbEntry), table.size(), file) == table.size();
+    return std::fclose(file) == 0 && ok;
+}
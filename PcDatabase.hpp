@@ -0,0 +1,87 @@
+#pragma once
+#include "Solver.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ==== パフェの答えを保存しておくデータベース（ファイル） ====
+// 「盤面（下から height 段）・ホールド・ネクスト」をキーに、パフェできるかどうかと、できるなら手順を1つ保存する
+// ・ファイルは PcDbBuild.cpp のプログラムで前もって作っておく（探索は時間がかかるため）
+// ・実行時はファイルをメモリにマップ（mmap）して読むだけなので、読み込みの時間がかからず、
+//   同じファイルを開いた複数のプロセスでメモリも共有される
+//
+// ファイルの形式（リトルエンディアンのCPUを前提に、構造体をそのまま書く）
+//   ヘッダ（PcDbHeader） + バケット（PcDbEntry × bucketCount）
+//   バケットはオープンアドレス法のハッシュ表（空いていなければ次のバケットを見る）
+
+// ファイルの先頭
+struct PcDbHeader {
+    char magic[4];                           // "PCDB"
+    std::uint32_t version;
+    std::uint64_t bucketCount;               // 2のべき乗
+    std::uint64_t entryCount;                // 使われているバケットの数
+    std::uint64_t reserved;
+};
+
+// 1件分（64バイト = キャッシュライン1本）
+struct PcDbEntry {
+    static const int MAX_SOLUTION = 22;      // 保存できる手順の長さ（空の盤面からの6段パフェの15手も入る）
+
+    std::uint64_t fieldKey;                  // 盤面のキー（PcDatabase::makeKey）
+    std::uint64_t queueKey;                  // ホールドとネクストのキー（PcDatabase::makeKey）
+    std::uint8_t used;                       // このバケットが使われているか
+    std::uint8_t solvable;                   // パフェできるか
+    std::uint8_t length;                     // 手順の長さ
+    std::uint8_t reserved;
+    std::uint16_t moves[MAX_SOLUTION];       // 手順（PcDatabase::encodeMove）
+};
+static_assert(sizeof(PcDbHeader) == 32, "PC database header layout");
+static_assert(sizeof(PcDbEntry) == 64, "PC database entry layout");
+
+// 調べた結果
+struct PcDbAnswer {
+    bool solvable = false;
+    Solution solution;                       // パフェできるなら、その手順（置いた順）
+};
+
+class PcDatabase {
+public:
+    // 1 は、段数の違う問題の「パフェできない」が混ざることがあった PcDbBuild で作ったもの。開かずに作り直してもらう
+    static const int VERSION = 2;
+    static const int MAX_HEIGHT = 6;         // キーにできる段数（10列 × 6段 = 60ビット）
+    static_assert(MAX_HEIGHT <= PcSolver::MAX_HEIGHT, "every database height must be solvable");
+    static const int MAX_QUEUE = 18;         // キーにできるピース数（現在のピース + ネクスト）
+
+    PcDatabase() = default;
+    ~PcDatabase();
+    PcDatabase(const PcDatabase&) = delete;
+    PcDatabase& operator=(const PcDatabase&) = delete;
+
+    // ファイルをマップして開く（形式が違えば false）
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+    std::uint64_t size() const { return header ? header->entryCount : 0; }
+
+    // 問題を調べる。データベースにあれば true を返し、answer に結果を入れる
+    bool lookup(const PcProblem& problem, PcDbAnswer& answer) const;
+
+    // ---- キーと手順の変換（ビルダーと共通） ----
+    // キーにできない問題（段数が多すぎる・height 段より上にブロックがある・ピースが多すぎる）なら false
+    static bool makeKey(const PcProblem& problem, std::uint64_t& fieldKey, std::uint64_t& queueKey);
+    static std::uint16_t encodeMove(const Placement& p);
+    static Placement decodeMove(std::uint16_t code);
+
+    // entries（キーの重複はないこと）からデータベースのファイルを書く
+    static bool write(const char* path, const std::vector<PcDbEntry>& entries);
+
+private:
+    const PcDbHeader* header = nullptr;
+    const PcDbEntry* entries = nullptr;
+    void* mapping = nullptr;                 // マップしたメモリの先頭
+    std::size_t mappedBytes = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,258 @@
+// ==== パフェのデータベース（PcDatabase）を作るプログラム ====
+// 問題を1つずつ PcSolver で解き、結果（パフェできない問題も含む）をファイルに書く
+// 問題は複数のスレッドで分担して解く（スレッドごとに1スレッドの PcSolver を使う）
+//
+// 使い方:
+//   PcDbBuild <出力ファイル> <問題ファイル> [スレッド数]
+//   PcDbBuild <出力ファイル> --random <問題数> <段数> <ピース数> [シード] [スレッド数]
+//       … 空の盤面・ホールドなしで、7種1巡のルールでランダムに作ったネクストの問題を解く
+//   PcDbBuild --verify <pc.db> <問題ファイル> [スレッド数]（--random も同じ書き方）
+//       … できたファイルを、問題ごとに新しい PcSolver で解き直した結果と突き合わせる（合わなければ終了コード1）
+//
+// 問題ファイルの形式（1行1問。空行と "//" で始まる行は読み飛ばす）
+//   <盤面> <段数> <ホールド> <ピース>
+//   盤面：上の行から順に '/' で区切って書き、盤面の一番下にそろえる（'#' = ブロック、'.' = 空き）。空の盤面は "empty"
+//   ホールド：ピースの文字（T S Z I O L J）か、なければ '-'
+//   ピース：現在のピースから順に並べる（例：IOTLJSZ）
+// 例：######..../######..../######..../######.... 4 - IOTLJSZ
+#include "PcDatabase.hpp"
+#include "Piece.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    bool pieceFromChar(char c, PieceType& type) {
+        static const char LETTERS[] = "TSZIOLJ";
+        const char* p = std::strchr(LETTERS, c);
+        if (c == '\0' || !p) return false;
+        type = static_cast<PieceType>(p - LETTERS);
+        return true;
+    }
+
+    // 問題ファイルの1行を読む（形式が違えば false）
+    bool parseProblem(const std::string& line, PcProblem& problem) {
+        std::istringstream in(line);
+        std::string field, holdText, queueText;
+        if (!(in >> field >> problem.height >> holdText >> queueText)) return false;
+
+        problem.field = Board();
+        if (field != "empty") {
+            std::vector<std::string> rows;
+            std::stringstream fs(field);
+            std::string row;
+            while (std::getline(fs, row, '/')) rows.push_back(row);
+            if (rows.size() > static_cast<std::size_t>(Board::HEIGHT)) return false;
+            int top = Board::HEIGHT - static_cast<int>(rows.size());
+            for (int r = 0; r < static_cast<int>(rows.size()); ++r) {
+                if (rows[r].size() != static_cast<std::size_t>(Board::WIDTH)) return false;
+                for (int x = 0; x < Board::WIDTH; ++x)
+                    if (rows[r][x] == '#') problem.field.placeBlock(x, top + r, 1);
+            }
+        }
+
+        problem.hold.reset();
+        PieceType type;
+        if (holdText != "-") {
+            if (holdText.size() != 1 || !pieceFromChar(holdText[0], type)) return false;
+            problem.hold = type;
+        }
+
+        problem.queue.clear();
+        for (std::size_t i = 0; i < queueText.size(); ++i) {
+            if (!pieceFromChar(queueText[i], type)) return false;
+            if (i == 0) problem.current = type;
+            else problem.queue.push_back(type);
+        }
+        return !queueText.empty();
+    }
+
+    // ホールドを使う回数が一番少ない手順（同じ回数なら、符号にした手順の並びが一番小さいもの）を選び、codes に入れる
+    // 見つかる順番で選ばないので、同じ問題からは毎回同じファイルができる
+    void pickSolution(const std::vector<Solution>& solutions, std::vector<std::uint16_t>& codes) {
+        int bestHolds = 0;
+        std::vector<std::uint16_t> candidate;
+        for (std::size_t i = 0; i < solutions.size(); ++i) {
+            int holds = 0;
+            candidate.clear();
+            for (const Placement& p : solutions[i]) {
+                holds += p.hold ? 1 : 0;
+                candidate.push_back(PcDatabase::encodeMove(p));
+            }
+            if (i == 0 || holds < bestHolds || (holds == bestHolds && candidate < codes)) {
+                bestHolds = holds;
+                codes = candidate;
+            }
+        }
+    }
+    // argv[2] から後ろ（問題ファイル、または --random と数）を読んで問題を集める。読めなければメッセージを出して false
+    bool collectProblems(int argc, char** argv, std::vector<PcProblem>& problems, unsigned& threads) {
+        threads = 0;
+        if (std::strcmp(argv[2], "--random") == 0) {
+            if (argc < 6) {
+                std::printf("--random needs <count> <height> <pieces>\n");
+                return false;
+            }
+            int count = std::atoi(argv[3]);
+            int height = std::atoi(argv[4]);
+            int pieces = std::atoi(argv[5]);
+            std::uint32_t seed = argc > 6 ? static_cast<std::uint32_t>(std::strtoul(argv[6], nullptr, 10)) : 1;
+            if (argc > 7) threads = static_cast<unsigned>(std::atoi(argv[7]));
+            if (pieces < 1) {
+                std::printf("pieces must be at least 1\n");
+                return false;
+            }
+            Bag bag(seed);
+            for (int i = 0; i < count; ++i) {
+                PcProblem problem;
+                problem.height = height;
+                problem.current = bag.getNext();
+                for (int k = 1; k < pieces; ++k) problem.queue.push_back(bag.getNext());
+                problems.push_back(problem);
+            }
+        }
+        else {
+            std::ifstream in(argv[2]);
+            if (!in) {
+                std::printf("cannot open %s\n", argv[2]);
+                return false;
+            }
+            std::string line;
+            int lineNumber = 0;
+            while (std::getline(in, line)) {
+                ++lineNumber;
+                if (line.empty() || line.compare(0, 2, "//") == 0) continue;
+                PcProblem problem;
+                if (!parseProblem(line, problem)) {
+                    std::printf("%s:%d: cannot parse problem\n", argv[2], lineNumber);
+                    return false;
+                }
+                problems.push_back(problem);
+            }
+            if (argc > 3) threads = static_cast<unsigned>(std::atoi(argv[3]));
+        }
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        return true;
+    }
+
+    // 作ったデータベースを、問題ごとに新しい PcSolver で解き直して確かめる（ビルダーと同じ手順を選ぶので、手順まで一致するはず）
+    // 探索の置換表が問題をまたいで混ざると「パフェできない」が別の段数にも書かれてしまうので、作り直したファイルはこれで確かめる
+    int verify(const char* dbPath, const std::vector<PcProblem>& problems, unsigned threads) {
+        PcDatabase db;
+        if (!db.open(dbPath)) {
+            std::printf("cannot open %s (missing, or built by an older PcDbBuild: rebuild it)\n", dbPath);
+            return 1;
+        }
+        std::atomic<std::size_t> nextIndex{ 0 };
+        std::atomic<int> checked{ 0 }, missing{ 0 }, wrong{ 0 };
+        auto work = [&] {
+            std::vector<std::uint16_t> codes, stored;
+            for (std::size_t i; (i = nextIndex.fetch_add(1)) < problems.size();) {
+                const PcProblem& problem = problems[i];
+                std::uint64_t fieldKey, queueKey;
+                if (!PcDatabase::makeKey(problem, fieldKey, queueKey)) continue;
+                checked.fetch_add(1);
+                PcDbAnswer answer;
+                if (!db.lookup(problem, answer)) {
+                    missing.fetch_add(1);
+                    continue;
+                }
+                PcSolver solver(1, 1); // 前の問題の置換表を使わないように、問題ごとに作る
+                std::vector<Solution> solutions = solver.solve(problem);
+                codes.clear();
+                if (!solutions.empty()) pickSolution(solutions, codes);
+                bool solvable = !codes.empty() && codes.size() <= static_cast<std::size_t>(PcDbEntry::MAX_SOLUTION);
+                stored.clear();
+                for (const Placement& p : answer.solution) stored.push_back(PcDatabase::encodeMove(p));
+                if (answer.solvable != solvable || (solvable && stored != codes)) wrong.fetch_add(1);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) workers.emplace_back(work);
+        for (std::thread& w : workers) w.join();
+
+        std::printf("%d problems checked against %s: %d missing, %d wrong\n", checked.load(), dbPath, missing.load(), wrong.load());
+        return missing.load() == 0 && wrong.load() == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || (std::strcmp(argv[1], "--verify") == 0 && argc < 4)) {
+        std::printf("usage: PcDbBuild <out.db> <problems.txt> [threads]\n"
+                    "       PcDbBuild <out.db> --random <count> <height> <pieces> [seed] [threads]\n"
+                    "       PcDbBuild --verify <pc.db> <problems.txt | --random ...> [threads]\n");
+        return 1;
+    }
+    if (std::strcmp(argv[1], "--verify") == 0) {
+        std::vector<PcProblem> problems;
+        unsigned threads = 0;
+        if (!collectProblems(argc - 1, argv + 1, problems, threads)) return 1;
+        return verify(argv[2], problems, threads);
+    }
+    const char* outPath = argv[1];
+
+    // ---- 問題を集める ----
+    std::vector<PcProblem> problems;
+    unsigned threads = 0;
+    if (!collectProblems(argc, argv, problems, threads)) return 1;
+
+    // ---- キーにできない問題と、重複した問題を除く ----
+    std::vector<PcDbEntry> entries;
+    std::vector<const PcProblem*> todo;
+    std::set<std::pair<std::uint64_t, std::uint64_t>> seen;
+    int skipped = 0;
+    for (const PcProblem& problem : problems) {
+        PcDbEntry e;
+        std::memset(&e, 0, sizeof(e));
+        if (!PcDatabase::makeKey(problem, e.fieldKey, e.queueKey)) {
+            ++skipped;
+            continue;
+        }
+        if (!seen.insert({ e.fieldKey, e.queueKey }).second) continue;
+        entries.push_back(e);
+        todo.push_back(&problem);
+    }
+
+    // ---- スレッドで分担して解く（次に解く問題の番号を atomic で取り合う） ----
+    std::atomic<std::size_t> nextIndex{ 0 };
+    std::atomic<int> solvableCount{ 0 };
+    auto start = std::chrono::steady_clock::now();
+    auto work = [&] {
+        // 1つの PcSolver を問題をまたいで使い回す（solve のたびに置換表の世代が進み、前の問題の結果は使われない）
+        PcSolver solver(1, 16);
+        std::vector<std::uint16_t> codes;
+        for (std::size_t i; (i = nextIndex.fetch_add(1)) < todo.size();) {
+            std::vector<Solution> solutions = solver.solve(*todo[i]);
+            PcDbEntry& e = entries[i];
+            if (solutions.empty()) continue;
+            pickSolution(solutions, codes);
+            if (codes.size() > static_cast<std::size_t>(PcDbEntry::MAX_SOLUTION)) continue;
+            e.solvable = 1;
+            e.length = static_cast<std::uint8_t>(codes.size());
+            std::copy(codes.begin(), codes.end(), e.moves);
+            solvableCount.fetch_add(1);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) workers.emplace_back(work);
+    for (std::thread& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!PcDatabase::write(outPath, entries)) {
+        std::printf("cannot write %s\n", outPath);
+        return 1;
+    }
+    std::printf("%zu problems (%d solvable, %d skipped) in %.2f s with %u threads -> %s\n",
+                entries.size(), solvableCount.load(), skipped, seconds, threads, outPath);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// ミノの形状・回転・ウォールキックをすべてコンパイル時に計算しておくテーブル
+// Piece::rotate や探索の内側のループでは、ここから値を読むだけにする
+// （SFMLに依存しないので、描画のないプログラムからも使える）
+
+// ==== ピースの種類（7種のテトリミノ） ====
+enum class PieceType { T, S, Z, I, O, L, J };
+// 回転状態
+enum class Rotation { Spawn = 0, Right = 1, Reverse = 2, Left = 3 };
+
+// 回転方向（ROTATION_KICKS の添字として使う）
+enum RotateDir { ROTATE_CW = 0, ROTATE_CCW = 1 };
+
+// constexpr で扱える2次元の整数座標（sf::Vector2i は constexpr にできないため）
+struct Cell {
+    int x, y;
+};
+
+// 1つの回転状態の形状
+struct Orientation {
+    std::array<Cell, 4> cells;              // 4マス分の相対座標
+    int minX, maxX, minY, maxY;             // 相対座標の範囲
+    int height;                             // 行数（maxY - minY + 1）
+    std::array<std::uint16_t, 4> rowMasks;  // 行 (minY + r) のビット列。ビット (x - minX) が埋まっている
+};
+
+// ==== 各ピースの形状定義（Spawn状態） ====
+// 各ピースは「4つの相対座標」で構成される
+inline constexpr std::array<std::array<Cell, 4>, 7> PIECE_SHAPES = { {
+    { { {0,0}, {-1,0}, {1,0}, {0,1} } },  // Tミノ
+    { { {0,0}, {1,0}, {0,1}, {-1,1} } },  // Sミノ
+    { { {0,0}, {-1,0}, {0,1}, {1,1} } },  // Zミノ
+    { { {-1,0}, {0,0}, {1,0}, {2,0} } },  // Iミノ
+    { { {0,0}, {1,0}, {0,1}, {1,1} } },   // Oミノ
+    { { {0,0}, {-1,0}, {-1,1}, {1,0} } }, // Jミノ
+    { { {0,0}, {-1,0}, {1,0}, {1,1} } }   // Lミノ
+} };
+
+// ------------------- ウォールキックテーブル -------------------
+// T, J, L, S, Z, O 用
+inline constexpr std::array<std::array<Cell, 5>, 8> WALL_KICKS = { {
+    { { {0,0}, {-1,0}, {-1,1}, {0,-2}, {-1,-2} } }, // 0->R
+    { { {0,0}, {1,0}, {1,-1}, {0,2}, {1,2} } },     // R->0
+    { { {0,0}, {1,0}, {1,-1}, {0,2}, {1,2} } },     // R->2
+    { { {0,0}, {-1,0}, {-1,1}, {0,-2}, {-1,-2} } }, // 2->R
+
+    { { {0,0}, {1,0}, {1,1}, {0,-2}, {1,-2} } },    // 2->L
+    { { {0,0}, {-1,0}, {-1,-1}, {0,2}, {-1,2} } },  // L->2
+    { { {0,0}, {-1,0}, {-1,-1}, {0,2}, {-1,2} } },  // L->0
+    { { {0,0}, {1,0}, {1,1}, {0,-2}, {1,-2} } }     // 0->L
+} };
+
+// Iミノ用
+inline constexpr std::array<std::array<Cell, 5>, 8> WALL_KICKS_I = { {
+    { { {0,0}, {-2,0}, {1,0}, {-2,1}, {1,-2} } },   // 0->R
+    { { {0,0}, {2,0}, {-1,0}, {2,-1}, {-1,2} } },   // R->0
+    { { {0,0}, {-1,0}, {2,0}, {-1,-2}, {2,1} } },   // R->2
+    { { {0,0}, {1,0}, {-2,-1}, {1,2}, {-2,-1} } },  // 2->R
+
+    { { {0,0}, {2,0}, {-1,0}, {2,-1}, {-1,2} } },   // 2->L
+    { { {0,0}, {-2,0}, {1,0}, {-2,1}, {1,-2} } },   // L->2
+    { { {0,0}, {1,0}, {-2,0}, {1,2}, {-2,-1} } },   // L->0
+    { { {0,0}, {-1,0}, {2,0}, {-1,-2}, {2,1} } }    // 0->L
+} };
+
+// 回転後の状態を返す（右回転なら +1、左回転なら +3）
+constexpr Rotation rotatedState(Rotation rot, int dir) {
+    return static_cast<Rotation>((static_cast<int>(rot) + (dir == ROTATE_CW ? 1 : 3)) & 3);
+}
+
+//ウォールキックテーブルからどの値を適応するかを返す関数
+constexpr int getKickIndex(Rotation oldRot, Rotation newRot) {
+    if (oldRot == Rotation::Spawn && newRot == Rotation::Right) return 0;
+    if (oldRot == Rotation::Right && newRot == Rotation::Spawn) return 1;
+    if (oldRot == Rotation::Right && newRot == Rotation::Reverse) return 2;
+    if (oldRot == Rotation::Reverse && newRot == Rotation::Right) return 3;
+    if (oldRot == Rotation::Reverse && newRot == Rotation::Left) return 4;
+    if (oldRot == Rotation::Left && newRot == Rotation::Reverse) return 5;
+    if (oldRot == Rotation::Left && newRot == Rotation::Spawn) return 6;
+    if (oldRot == Rotation::Spawn && newRot == Rotation::Left) return 7;
+    return -1;
+}
+
+// Spawn状態の形状を r 回だけ右回転 (x,y) -> (-y,x) した形状を作る
+constexpr Orientation makeOrientation(const std::array<Cell, 4>& spawn, int r) {
+    Orientation o{};
+    for (int i = 0; i < 4; ++i) {
+        Cell c = spawn[i];
+        for (int k = 0; k < r; ++k) c = Cell{ -c.y, c.x };
+        o.cells[i] = c;
+    }
+    o.minX = o.maxX = o.cells[0].x;
+    o.minY = o.maxY = o.cells[0].y;
+    for (const Cell& c : o.cells) {
+        if (c.x < o.minX) o.minX = c.x;
+        if (c.x > o.maxX) o.maxX = c.x;
+        if (c.y < o.minY) o.minY = c.y;
+        if (c.y > o.maxY) o.maxY = c.y;
+    }
+    o.height = o.maxY - o.minY + 1;
+    for (const Cell& c : o.cells)
+        o.rowMasks[c.y - o.minY] |= static_cast<std::uint16_t>(1u << (c.x - o.minX));
+    return o;
+}
+
+constexpr std::array<std::array<Orientation, 4>, 7> buildOrientations() {
+    std::array<std::array<Orientation, 4>, 7> table{};
+    for (int t = 0; t < 7; ++t)
+        for (int r = 0; r < 4; ++r)
+            table[t][r] = makeOrientation(PIECE_SHAPES[t], r);
+    return table;
+}
+
+// (種類, 回転元, 方向) ごとに、適用するキック5つを解決済みにしておく
+constexpr std::array<std::array<std::array<std::array<Cell, 5>, 2>, 4>, 7> buildKicks() {
+    std::array<std::array<std::array<std::array<Cell, 5>, 2>, 4>, 7> table{};
+    for (int t = 0; t < 7; ++t)
+        for (int r = 0; r < 4; ++r)
+            for (int d = 0; d < 2; ++d) {
+                Rotation from = static_cast<Rotation>(r);
+                int kickIndex = getKickIndex(from, rotatedState(from, d));
+                const auto& kicks = (static_cast<PieceType>(t) == PieceType::I) ? WALL_KICKS_I : WALL_KICKS;
+                table[t][r][d] = kicks[kickIndex];
+            }
+    return table;
+}
+
+// ORIENTATIONS[種類][回転状態]
+inline constexpr auto ORIENTATIONS = buildOrientations();
+// ROTATION_KICKS[種類][回転元][ROTATE_CW / ROTATE_CCW]
+inline constexpr auto ROTATION_KICKS = buildKicks();
+
+// テーブル参照の補助関数
+constexpr const Orientation& orientationOf(PieceType type, Rotation rot) {
+    return ORIENTATIONS[static_cast<int>(type)][static_cast<int>(rot)];
+}
+constexpr const std::array<Cell, 5>& kicksOf(PieceType type, Rotation rot, int dir) {
+    return ROTATION_KICKS[static_cast<int>(type)][static_cast<int>(rot)][dir];
+}
+
+// コンパイル時に形状が正しいかを確認する
+static_assert(ORIENTATIONS[static_cast<int>(PieceType::I)][1].height == 4, "I mino (Right) must span 4 rows");
+static_assert(ORIENTATIONS[static_cast<int>(PieceType::T)][0].rowMasks[0] == 0b111, "T mino (Spawn) top row");
+static_assert(ROTATION_KICKS[static_cast<int>(PieceType::I)][0][ROTATE_CW][1].x == -2, "I kick 0->R");
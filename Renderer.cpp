@@ -0,0 +1,173 @@
+#include "Renderer.hpp"
+
+// ==== 各ピースの色定義 ====
+const std::array<sf::Color, 7> PIECE_COLORS = {
+    sf::Color(255,0,255),   // T = 紫
+    sf::Color::Green,       // S = 緑
+    sf::Color::Red,         // Z = 赤
+    sf::Color::Cyan,        // I = 水色
+    sf::Color::Yellow,      // O = 黄色
+    sf::Color(255,165,0),   // J = 青
+    sf::Color::Blue        // L = オレンジ
+};
+
+namespace {
+    const sf::Color EMPTY_COLOR(30, 30, 30); // 空きマスは濃いグレー
+    const sf::Color GARBAGE_COLOR(120, 120, 120); // ガベージは明るいグレー
+    const std::uint8_t GHOST = 8;            // マスの中身の値：GHOST + 種類 でゴースト
+
+    // マスの中身の値を実際の色にする
+    sf::Color colorOf(std::uint8_t code) {
+        if (code == Board::EMPTY) return EMPTY_COLOR;
+        if (code == Board::GARBAGE) return GARBAGE_COLOR;
+        if (code < GHOST) return PIECE_COLORS[code - 1];
+        // ゴーストはピースの色を背景に近づけて暗くする
+        sf::Color c = PIECE_COLORS[code - GHOST];
+        return sf::Color(static_cast<sf::Uint8>((c.r + EMPTY_COLOR.r * 3) / 4),
+                         static_cast<sf::Uint8>((c.g + EMPTY_COLOR.g * 3) / 4),
+                         static_cast<sf::Uint8>((c.b + EMPTY_COLOR.b * 3) / 4));
+    }
+
+    // プレビュー欄の左上の位置（Next は上から順に、Hold は一番下）
+    sf::Vector2f previewOrigin(int slot) {
+        float px = static_cast<float>(Board::WIDTH * Renderer::CELL_SIZE + 20);
+        float py = slot < Simulation::NEXT_COUNT ? static_cast<float>(20 + slot * 100) : 600.f;
+        return sf::Vector2f(px, py);
+    }
+}
+
+// ==================== Renderer クラス ====================
+// コンストラクタ：全マスの四角形を作っておく（盤面はすべて空、プレビューは透明）
+Renderer::Renderer() : vertices(sf::Quads, QUAD_COUNT * 4) {
+    for (int y = 0; y < Board::HEIGHT; ++y)
+        for (int x = 0; x < Board::WIDTH; ++x)
+            setQuad(y * Board::WIDTH + x, static_cast<float>(x * CELL_SIZE), static_cast<float>(y * CELL_SIZE),
+                    static_cast<float>(CELL_SIZE), EMPTY_COLOR);
+    fieldShown.fill(Board::EMPTY);
+
+    for (int q = FIELD_CELLS; q < QUAD_COUNT; ++q) setQuad(q, 0.f, 0.f, 0.f, sf::Color::Transparent);
+    previewShown.fill(NO_PIECE);
+}
+
+// 四角形1つ分（頂点4つ）の位置と色を書く
+// 枠付きで描画するため、1px 小さくしている
+void Renderer::setQuad(int quad, float x, float y, float size, sf::Color color) {
+    float s = size > 0.f ? size - 1.f : 0.f;
+    sf::Vertex* v = &vertices[static_cast<std::size_t>(quad) * 4];
+    v[0].position = sf::Vector2f(x, y);
+    v[1].position = sf::Vector2f(x + s, y);
+    v[2].position = sf::Vector2f(x + s, y + s);
+    v[3].position = sf::Vector2f(x, y + s);
+    for (int i = 0; i < 4; ++i) v[i].color = color;
+}
+
+void Renderer::setQuadColor(int quad, sf::Color color) {
+    sf::Vertex* v = &vertices[static_cast<std::size_t>(quad) * 4];
+    for (int i = 0; i < 4; ++i) v[i].color = color;
+}
+
+// プレビュー欄1つ分（4マス）を、type のピースの出現時の向きで書き直す
+void Renderer::setPreview(int slot, std::uint8_t type) {
+    int first = FIELD_CELLS + slot * 4;
+    if (type == NO_PIECE) {
+        for (int i = 0; i < 4; ++i) setQuadColor(first + i, sf::Color::Transparent);
+        return;
+    }
+    sf::Vector2f origin = previewOrigin(slot);
+    const Orientation& o = orientationOf(static_cast<PieceType>(type), Rotation::Spawn);
+    for (int i = 0; i < 4; ++i)
+        setQuad(first + i, origin.x + o.cells[i].x * PREVIEW_SIZE, origin.y + o.cells[i].y * PREVIEW_SIZE,
+                static_cast<float>(PREVIEW_SIZE), PIECE_COLORS[type]);
+}
+
+// このフレームで表示する内容を作り、前のフレームと違うマスだけ書き換える
+void Renderer::update(const Simulation& sim) {
+    changed = 0;
+
+    // --- 盤面 + ゴースト + 操作中のピース ---
+    std::array<std::uint8_t, FIELD_CELLS> frame;
+    const Board& board = sim.board();
+    for (int y = 0; y < Board::HEIGHT; ++y)
+        for (int x = 0; x < Board::WIDTH; ++x)
+            frame[y * Board::WIDTH + x] = board.colors[y][x];
+
+    const Piece& piece = sim.current();
+    int drop = sim.dropDistance();
+    for (const Cell& p : piece.getAbsolutePositions()) {
+        int gy = p.y + drop;
+        if (gy >= 0 && gy < Board::HEIGHT && frame[gy * Board::WIDTH + p.x] == Board::EMPTY)
+            frame[gy * Board::WIDTH + p.x] = static_cast<std::uint8_t>(GHOST + static_cast<int>(piece.type));
+    }
+    // ピースはゴーストより上に描く（盤面より上にはみ出した部分は描かない）
+    for (const Cell& p : piece.getAbsolutePositions())
+        if (p.y >= 0 && p.y < Board::HEIGHT) frame[p.y * Board::WIDTH + p.x] = piece.colorId();
+
+    for (int i = 0; i < FIELD_CELLS; ++i) {
+        if (frame[i] == fieldShown[i]) continue;
+        fieldShown[i] = frame[i];
+        setQuadColor(i, colorOf(frame[i]));
+        ++changed;
+    }
+
+    // --- Next5 と Hold ---
+    const NextQueue& next = sim.next();
+    for (int slot = 0; slot < PREVIEW_COUNT; ++slot) {
+        std::uint8_t type = NO_PIECE;
+        if (slot < Simulation::NEXT_COUNT) {
+            if (slot < next.size()) type = static_cast<std::uint8_t>(next[slot]);
+        }
+        else if (sim.hold()) {
+            type = static_cast<std::uint8_t>(*sim.hold());
+        }
+        if (type == previewShown[slot]) continue;
+        previewShown[slot] = type;
+        setPreview(slot, type);
+        changed += 4;
+    }
+}
+
+// おすすめの置き場所を、ピースの外側の辺だけの枠にする（1位は白、2位・3位はグレー）
+bool Renderer::updateOverlay(const AdvisorResult& result, std::uint64_t generation) {
+    bool current = result.generation == generation;
+    int depth = current ? result.depth : 0;
+    if (depth == overlayDepth && (!current || overlayGeneration == generation)) return false;
+    overlayGeneration = generation;
+    overlayDepth = depth;
+    overlayCount = 0;
+    if (!current) return true; // 古いピースの結果は表示しない
+
+    static const sf::Color RANK_COLORS[AdvisorResult::MAX_SUGGESTIONS] = {
+        sf::Color(255, 255, 255), sf::Color(160, 160, 160), sf::Color(90, 90, 90)
+    };
+    static const int DX[4] = { 0, 1, 0, -1 }, DY[4] = { -1, 0, 1, 0 };
+    for (int rank = result.count - 1; rank >= 0; --rank) { // 1位を最後に描いて一番上に見せる
+        const Placement& p = result.suggestions[rank].placement;
+        const Orientation& o = orientationOf(p.type, p.rotation);
+        for (const Cell& c : o.cells) {
+            int cx = p.x + c.x, cy = p.y + c.y;
+            if (cy < 0) continue;
+            for (int d = 0; d < 4; ++d) {
+                // となりのマスも同じピースなら、その辺は内側なので描かない
+                bool inside = false;
+                for (const Cell& n : o.cells)
+                    if (n.x == c.x + DX[d] && n.y == c.y + DY[d]) inside = true;
+                if (inside) continue;
+
+                // 辺の両端（d = 0:上, 1:右, 2:下, 3:左）
+                float x0 = static_cast<float>(cx * CELL_SIZE), y0 = static_cast<float>(cy * CELL_SIZE);
+                float x1 = x0 + CELL_SIZE - 1, y1 = y0 + CELL_SIZE - 1;
+                sf::Vector2f a = d == 1 ? sf::Vector2f(x1, y0) : d == 2 ? sf::Vector2f(x0, y1) : sf::Vector2f(x0, y0);
+                sf::Vector2f b = d == 0 ? sf::Vector2f(x1, y0) : d == 3 ? sf::Vector2f(x0, y1) : sf::Vector2f(x1, y1);
+                overlay[overlayCount++] = sf::Vertex(a, RANK_COLORS[rank]);
+                overlay[overlayCount++] = sf::Vertex(b, RANK_COLORS[rank]);
+            }
+        }
+    }
+    return true;
+}
+
+// 全マスを1回、おすすめの枠を1回の draw で描く
+void Renderer::draw(sf::RenderWindow& window) const {
+    window.draw(vertices);
+    if (overlayCount > 0) window.draw(overlay.data(), static_cast<std::size_t>(overlayCount), sf::Lines);
+}
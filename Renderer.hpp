@@ -0,0 +1,63 @@
+#pragma once
+#include "Advisor.hpp"
+#include "Simulation.hpp"
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+
+//sf::について
+//sfとは、SFMLライブラリの名前空間のこと
+//sf::colorで色を扱うクラス、sf::RenderWindowでゲーム画面を描画するウィンドウ、sf::Vector2iで2次元の整数ベクトル(x,y)など
+//sf::Color c = sf::Color::Redで赤色、sf::Vector2i v(1, 2)でx=1, y = 2
+
+//externについて
+//externはここでは宣言だけで、実態はcppファイルにあるという意味
+//今回はミノの色の宣言で使用
+
+// ==== ピースの色の定義（実体は .cpp 側で定義） ====
+// それぞれのミノの色
+extern const std::array<sf::Color, 7> PIECE_COLORS;
+
+// ==== 画面の描画をまとめて行うクラス ====
+// 盤面・操作中のピース・ゴースト・Next・Hold の全マスを、1つの sf::VertexArray（四角形1つ = 頂点4つ）で持つ
+// ・頂点の位置は最初に1回だけ決め、毎フレームは前のフレームから変わったマスの色だけを書き換える
+// ・描画は draw の1回だけ（マスごとに sf::RectangleShape を作って draw するより、ずっとCPUの負担が小さい）
+// ・おすすめの置き場所（PlacementAdvisor の結果）は、別の線の頂点配列で枠だけを描く（draw がもう1回増える）
+class Renderer {
+public:
+    static const int CELL_SIZE = 40;                         // 盤面の1マスの大きさ（px）
+    static const int PREVIEW_SIZE = 20;                      // Next・Hold の1マスの大きさ（px）
+    static const int PREVIEW_COUNT = Simulation::NEXT_COUNT + 1; // Next5 + Hold
+
+    Renderer();
+
+    void update(const Simulation& sim);      // 前のフレームから変わったマスだけ頂点を書き換える
+    // おすすめの置き場所の枠を作り直す（result が generation 向けの結果でなければ消す）
+    // 表示が変わったら true を返す
+    bool updateOverlay(const AdvisorResult& result, std::uint64_t generation);
+    void draw(sf::RenderWindow& window) const; // 全マスを1回、おすすめの枠を1回の draw で描く
+    int changedCells() const { return changed; } // 直前の update で書き換えたマスの数（デバッグ用）
+
+private:
+    static const int FIELD_CELLS = Board::WIDTH * Board::HEIGHT;
+    static const int QUAD_COUNT = FIELD_CELLS + PREVIEW_COUNT * 4;
+    static const std::uint8_t NO_PIECE = 0xFF;               // プレビュー欄が空（Holdがまだない）
+
+    sf::VertexArray vertices;
+    // 今表示しているマスの中身（0 = 空、1～7 = ブロック、8～14 = ゴースト）
+    std::array<std::uint8_t, FIELD_CELLS> fieldShown;
+    // 今表示しているプレビュー欄のピースの種類（NO_PIECE なら空）
+    std::array<std::uint8_t, PREVIEW_COUNT> previewShown;
+    int changed = 0;
+
+    // おすすめの枠（1マスの辺1本 = 頂点2つ。ピース1つで最大16本）
+    static const int OVERLAY_VERTICES = AdvisorResult::MAX_SUGGESTIONS * 4 * 4 * 2;
+    std::array<sf::Vertex, OVERLAY_VERTICES> overlay;
+    int overlayCount = 0;
+    std::uint64_t overlayGeneration = 0;     // 今表示している結果の番号と深さ
+    int overlayDepth = -1;
+
+    void setQuad(int quad, float x, float y, float size, sf::Color color); // 位置と色を書く
+    void setQuadColor(int quad, sf::Color color);                          // 色だけ書き換える
+    void setPreview(int slot, std::uint8_t type);                          // プレビュー欄1つ分を書き換える
+};
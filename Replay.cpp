@@ -0,0 +1,166 @@
+#include "Replay.hpp"
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const std::uint8_t MAGIC[4] = { 'T', 'R', 'P', 'L' };
+    const int DELTA_ESCAPE = 15;             // 上位4ビットがこの値なら、続けて可変長整数が来る
+    const int OLDEST_VERSION = 1;            // 読めるいちばん古いバージョン
+
+    void putU32(std::uint8_t* p, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+    void putU64(std::uint8_t* p, std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+    std::uint32_t getU32(const std::uint8_t* p) {
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+        return v;
+    }
+    std::uint64_t getU64(const std::uint8_t* p) {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+        return v;
+    }
+}
+
+// ==================== ReplayWriter クラス ====================
+// ヘッダの場所だけ空けておき、finish で中身を書く
+// gravity が切り詰められると再生したときに落ちる速さが変わって一致しなくなるので、書けない値は受け付けない
+bool ReplayWriter::begin(std::uint32_t seed, int gravity) {
+    if (gravity < 0 || gravity > MAX_GRAVITY) return false;
+    data.assign(HEADER_SIZE, 0);
+    lastTick = 0;
+    events = 0;
+    seedValue = seed;
+    gravityValue = gravity;
+    return true;
+}
+
+void ReplayWriter::record(std::uint64_t tick, Action action) {
+    std::uint64_t delta = tick - lastTick;
+    lastTick = tick;
+    ++events;
+
+    int code = static_cast<int>(action);
+    if (delta < static_cast<std::uint64_t>(DELTA_ESCAPE)) {
+        // ほとんどの操作はここで1バイトに収まる
+        data.push_back(static_cast<std::uint8_t>(code | (static_cast<int>(delta) << 4)));
+        return;
+    }
+    data.push_back(static_cast<std::uint8_t>(code | (DELTA_ESCAPE << 4)));
+    delta -= DELTA_ESCAPE;
+    while (delta >= 0x80) {
+        data.push_back(static_cast<std::uint8_t>(delta | 0x80));
+        delta >>= 7;
+    }
+    data.push_back(static_cast<std::uint8_t>(delta));
+}
+
+void ReplayWriter::finish(const Simulation& sim) {
+    std::uint8_t* p = data.data();
+    for (int i = 0; i < 4; ++i) p[i] = MAGIC[i];
+    p[4] = static_cast<std::uint8_t>(VERSION);
+    for (int i = 0; i < 3; ++i) p[5 + i] = static_cast<std::uint8_t>(gravityValue >> (8 * i));
+    putU32(p + 8, seedValue);
+    putU32(p + 12, events);
+    putU32(p + 16, static_cast<std::uint32_t>(data.size() - HEADER_SIZE));
+    putU32(p + 20, static_cast<std::uint32_t>(sim.stats().ticks));
+    putU32(p + 24, static_cast<std::uint32_t>(sim.stats().pieces));
+    putU64(p + 28, sim.board().hash);
+}
+
+// ==================== ReplayReader クラス ====================
+ReplayReader::ReplayReader(const std::uint8_t* data, std::size_t size) {
+    if (size < ReplayWriter::HEADER_SIZE) return;
+    for (int i = 0; i < 4; ++i)
+        if (data[i] != MAGIC[i]) return;
+    if (data[4] < OLDEST_VERSION || data[4] > ReplayWriter::VERSION) return;
+
+    head.gravity = data[5] | (data[6] << 8) | (data[7] << 16);
+    head.seed = getU32(data + 8);
+    head.eventCount = getU32(data + 12);
+    head.payloadBytes = getU32(data + 16);
+    head.finalTick = getU32(data + 20);
+    head.pieces = getU32(data + 24);
+    head.finalHash = getU64(data + 28);
+    if (head.payloadBytes > size - ReplayWriter::HEADER_SIZE) return;
+
+    cursor = data + ReplayWriter::HEADER_SIZE;
+    end = cursor + head.payloadBytes;
+    remaining = head.eventCount;
+    ok = true;
+}
+
+bool ReplayReader::next(std::uint64_t& tick, Action& action) {
+    if (!ok || remaining == 0) return false;
+    if (cursor == end) { ok = false; return false; }
+
+    std::uint8_t byte = *cursor++;
+    int code = byte & 0x0F;
+    if (code > static_cast<int>(Action::MoveUp)) { ok = false; return false; }
+    std::uint64_t delta = static_cast<std::uint64_t>(byte >> 4);
+    if (delta == static_cast<std::uint64_t>(DELTA_ESCAPE)) {
+        // 可変長整数（7ビットずつ）
+        std::uint64_t extra = 0;
+        int shift = 0;
+        for (;;) {
+            if (cursor == end || shift > 56) { ok = false; return false; }
+            std::uint8_t b = *cursor++;
+            extra |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+            shift += 7;
+        }
+        delta += extra;
+    }
+
+    tickValue += delta;
+    tick = tickValue;
+    action = static_cast<Action>(code);
+    --remaining;
+    return true;
+}
+
+// ==================== 再生 ====================
+ReplayCheck verifyReplay(const std::uint8_t* data, std::size_t size, Simulation& sim) {
+    ReplayCheck result;
+    ReplayReader reader(data, size);
+    if (!reader.valid()) return result;
+    const ReplayHeader& head = reader.header();
+
+    sim.gravity = head.gravity;
+    sim.reset(head.seed);
+
+    // 記録されたティックまで進めてから操作を入れる（ゲームオーバーになったらティックは進まない）
+    std::uint64_t tick;
+    Action action;
+    while (reader.next(tick, action)) {
+        while (sim.stats().ticks < tick && !sim.isGameOver()) sim.tick();
+        sim.apply(action);
+    }
+    if (!reader.valid()) return result;
+    while (sim.stats().ticks < head.finalTick && !sim.isGameOver()) sim.tick();
+
+    result.valid = true;
+    result.hash = sim.board().hash;
+    result.ticks = sim.stats().ticks;
+    result.pieces = sim.stats().pieces;
+    result.bytes = reader.totalBytes();
+    result.matched = result.hash == head.finalHash && result.ticks == head.finalTick && result.pieces == head.pieces;
+    return result;
+}
+
+bool saveReplayFile(const char* path, const std::vector<std::uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+bool loadReplayFile(const char* path, std::vector<std::uint8_t>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "Simulation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ==== リプレイ（1ゲーム分の操作の記録と再生） ====
+// 記録するのは「bagのシード」と「操作とそのティック」だけで、盤面は再生するときに計算し直す
+// 最後に盤面のハッシュを記録しておき、再生した結果と一致するかで同じゲームになったかを確かめる
+//
+// 形式（数値はすべてリトルエンディアン）
+//   ヘッダ（HEADER_SIZE バイト）
+//     "TRPL" / バージョン(1) / gravity(3) / シード(4) / 操作の数(4) /
+//     操作部分のバイト数(4) / 最後のティック(4) / 固定したピース数(4) / 最後の盤面のハッシュ(8)
+//   操作（1つにつき基本1バイト）
+//     下位4ビット = Action、上位4ビット = 前の操作からのティック数（0～14）
+//     ティック数が15以上なら上位4ビットを15にして、続けて (ティック数 - 15) を可変長整数で書く
+//     （7ビットずつ、続きがあれば最上位ビットを立てる）
+// バージョン1では gravity が1バイト（続く2バイトは予約で0）だったので、バージョン2の読み方でそのまま読める
+// ヘッダに操作部分のバイト数があるので、複数のリプレイをそのまま連結して1つのファイルにできる
+
+// ヘッダの中身
+struct ReplayHeader {
+    std::uint32_t seed = 0;                  // bagのシード
+    int gravity = 0;                         // Simulation::gravity
+    std::uint32_t eventCount = 0;            // 操作の数
+    std::uint32_t payloadBytes = 0;          // ヘッダの後ろにある操作部分のバイト数
+    std::uint32_t finalTick = 0;             // 記録を終えたときのティック数
+    std::uint32_t pieces = 0;                // 記録を終えたときまでに固定したピース数
+    std::uint64_t finalHash = 0;             // 記録を終えたときの盤面のハッシュ
+};
+
+// ==== リプレイを書き出すクラス ====
+// begin → (操作のたびに) record → finish の順に呼ぶ
+class ReplayWriter {
+public:
+    static const int VERSION = 2;
+    static const std::size_t HEADER_SIZE = 36;
+    static const int MAX_GRAVITY = 0xFFFFFF; // ヘッダに書ける gravity の最大値（3バイト）
+
+    // 記録を始める（それまでの内容は消える）
+    // gravity がヘッダに書けない値（負か MAX_GRAVITY より大きい）なら、何もせず false を返す
+    bool begin(std::uint32_t seed, int gravity);
+    // tick（Simulation::stats().ticks）の時点で action を入力したことを記録する
+    void record(std::uint64_t tick, Action action);
+    // sim の最後の状態をヘッダに書き込んで記録を終える
+    void finish(const Simulation& sim);
+
+    const std::vector<std::uint8_t>& bytes() const { return data; }
+    std::uint32_t eventCount() const { return events; }
+
+private:
+    std::vector<std::uint8_t> data;
+    std::uint64_t lastTick = 0;
+    std::uint32_t events = 0;
+    std::uint32_t seedValue = 0;
+    int gravityValue = 0;
+};
+
+// ==== リプレイを読むクラス ====
+// メモリ上のバイト列を先頭から1つずつ読む（メモリ確保はしない）
+class ReplayReader {
+public:
+    // data の先頭にあるリプレイを読む。ヘッダが壊れていれば valid() が false になる
+    ReplayReader(const std::uint8_t* data, std::size_t size);
+
+    bool valid() const { return ok; }
+    const ReplayHeader& header() const { return head; }
+    std::size_t totalBytes() const { return ReplayWriter::HEADER_SIZE + head.payloadBytes; } // このリプレイ全体のバイト数
+
+    // 次の操作を読む（もうなければ false）。tick にはその操作を入力したティックが入る
+    bool next(std::uint64_t& tick, Action& action);
+
+private:
+    ReplayHeader head;
+    const std::uint8_t* cursor = nullptr;
+    const std::uint8_t* end = nullptr;
+    std::uint64_t tickValue = 0;
+    std::uint32_t remaining = 0;
+    bool ok = false;
+};
+
+// 再生した結果
+struct ReplayCheck {
+    bool valid = false;                      // 形式が正しく読めたか
+    bool matched = false;                    // 最後の盤面のハッシュ・ティック数・ピース数が記録と一致したか
+    std::uint64_t hash = 0;                  // 再生した結果の盤面のハッシュ
+    std::uint64_t ticks = 0;
+    std::uint64_t pieces = 0;
+    std::size_t bytes = 0;                   // 読んだバイト数（連結されたファイルで次のリプレイに進むのに使う）
+};
+
+// data の先頭にあるリプレイを、sim を使って画面なしで最後まで再生し、記録と一致するか調べる
+// sim は使い回せる（毎回 reset される）
+ReplayCheck verifyReplay(const std::uint8_t* data, std::size_t size, Simulation& sim);
+
+// ファイルの読み書き（失敗したら false）
+bool saveReplayFile(const char* path, const std::vector<std::uint8_t>& bytes);
+bool loadReplayFile(const char* path, std::vector<std::uint8_t>& bytes);
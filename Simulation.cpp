@@ -0,0 +1,166 @@
+#include "Simulation.hpp"
+#include "Collision.hpp"
+
+// コンストラクタ：最初のピースとNextを用意する
+Simulation::Simulation() : currentPiece(PieceType::T) {
+    reset();
+}
+
+// 新しいゲームを始める（盤面・ホールド・Nextを作り直す）
+void Simulation::reset() {
+    field = Board();
+    nextQueue.clear();
+    holdPiece.reset();
+    holdLocked = false;
+    gameOver = false;
+    fallCounter = 0;
+    counters = SimStats();
+
+    PieceType first = bag.getNext();
+    // Nextキューに最初の5つを補充
+    for (int i = 0; i < NEXT_COUNT; ++i) nextQueue.push_back(bag.getNext());
+    spawn(first);
+}
+
+// bagのシードを指定して新しいゲームを始める
+// 同じシード・同じ操作なら、必ず同じゲームになる
+void Simulation::reset(std::uint32_t seed) {
+    bag.reseed(seed);
+    reset();
+}
+
+// Nextの先頭を取り出し、bagから1つ補充する
+PieceType Simulation::takeNext() {
+    PieceType p = nextQueue.front();
+    nextQueue.pop_front();
+    nextQueue.push_back(bag.getNext());
+    return p;
+}
+
+// 新しいピースを出現位置（左上からx=3,y=0）に出す
+void Simulation::spawn(PieceType type) {
+    currentPiece = Piece(type);
+    fallCounter = 0;
+    ++spawned;
+    // 出現位置が埋まっていたらゲームオーバー
+    if (!currentPiece.canMove(field, 0, 0)) gameOver = true;
+}
+
+// 現在のピースを固定し、ラインを消して次のピースを出す
+void Simulation::lock() {
+    std::uint32_t cleared = currentPiece.placeAndClear(field); // 盤面に固定してライン消去（ピースがかかった行だけ調べる）
+    int lines = Board::countLines(cleared);
+    lastLockResult = LockResult{ currentPiece.type, lines, cleared, lines > 0 && field.blockCount == 0 };
+    ++counters.pieces;
+    counters.lines += static_cast<std::uint64_t>(lines);
+
+    holdLocked = false;                        // ホールド使用可能に戻す
+    spawn(takeNext());
+}
+
+// Hold機能
+void Simulation::doHold() {
+    PieceType type = currentPiece.type;
+    if (!holdPiece) {
+        // === 初回ホールド ===
+        // 現在のピースをホールドし、Nextキューの先頭のピースを出す
+        holdPiece = type;
+        spawn(takeNext());
+    }
+    else {
+        // === 2回目以降のHold ===
+        // hold中のピースと入れ替えて、出現位置から出し直す
+        PieceType held = *holdPiece;
+        holdPiece = type;
+        spawn(held);
+    }
+    // このターンではもうHoldを使えないようにフラグを立てる
+    holdLocked = true;
+}
+
+// 操作を1つ適用する
+bool Simulation::apply(Action action) {
+    if (gameOver) return false;
+
+    switch (action) {
+    case Action::MoveLeft:
+        if (!currentPiece.canMove(field, -1, 0)) return false;
+        currentPiece.move(-1, 0);
+        return true;
+    case Action::MoveRight:
+        if (!currentPiece.canMove(field, 1, 0)) return false;
+        currentPiece.move(1, 0);
+        return true;
+    case Action::SoftDrop:
+        if (!currentPiece.canMove(field, 0, 1)) return false;
+        currentPiece.move(0, 1);
+        return true;
+    case Action::MoveUp:
+        if (!currentPiece.canMove(field, 0, -1)) return false;
+        currentPiece.move(0, -1);
+        return true;
+    case Action::RotateCW:
+        return currentPiece.rotate(field, true);
+    case Action::RotateCCW:
+        return currentPiece.rotate(field, false);
+    case Action::HardDrop:
+        currentPiece.move(0, dropDistance()); // 一番下まで落とす
+        lock();
+        return true;
+    case Action::Hold:
+        if (holdLocked) return false;
+        doHold();
+        return true;
+    case Action::None:
+        break;
+    }
+    return false;
+}
+
+// 現在のピースが何段下まで落ちられるか（ハードドロップの移動量・ゴーストの位置）
+// 1段ずつ canMove で調べる代わりに、CollisionField でその向きの置ける位置をまとめて求めて数える
+int Simulation::dropDistance() const {
+    CollisionField::Columns columns;
+    CollisionField(field).fitColumns(orientationOf(currentPiece.type, currentPiece.rotation), columns);
+    return CollisionField::dropDistance(columns, currentPiece.x, currentPiece.y);
+}
+
+// 重力で1段落とす（動けない＝着地なら盤面に固定）
+bool Simulation::fall() {
+    if (gameOver) return false;
+    if (currentPiece.canMove(field, 0, 1)) {
+        currentPiece.move(0, 1);
+        return false;
+    }
+    lock();
+    return true;
+}
+
+// ガベージのせり上がり（Replay には記録されないので、対戦でだけ使う）
+bool Simulation::addGarbage(int lines, int hole) {
+    if (gameOver) return false;
+    if (!field.addGarbage(lines, hole)) gameOver = true;
+    for (int up = 0; !gameOver && !currentPiece.canMove(field, 0, 0); ++up) {
+        if (up >= lines) gameOver = true;
+        else currentPiece.move(0, -1);
+    }
+    return !gameOver;
+}
+
+// 消したライン数ごとの攻撃（1列:0 2列:1 3列:2 4列:4）、パフェはさらに10段
+int attackOf(const LockResult& lock) {
+    static const int LINE_ATTACK[5] = { 0, 0, 1, 2, 4 };
+    const int PERFECT_CLEAR_ATTACK = 10;
+    int lines = lock.linesCleared < 0 ? 0 : (lock.linesCleared > 4 ? 4 : lock.linesCleared);
+    return LINE_ATTACK[lines] + (lock.perfectClear ? PERFECT_CLEAR_ATTACK : 0);
+}
+
+// 1ティック進める
+void Simulation::tick() {
+    if (gameOver) return;
+    ++counters.ticks;
+    if (gravity > 0 && ++fallCounter >= gravity) {
+        fallCounter = 0;
+        fall();
+    }
+}
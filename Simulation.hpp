@@ -0,0 +1,102 @@
+#pragma once
+#include "Action.hpp"
+#include "Board.hpp"
+#include "Piece.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+
+// ==== ゲームのルール本体（描画・キーボード・時計に依存しない） ====
+// 出現・移動・回転・ホールド・固定・ライン消去・bagの補充を、
+// 「操作 (Action)」と「ティック (tick)」だけで進める状態機械
+// ・SFMLを使わないので、ウィンドウのない環境（CIなど）でも動く
+// ・すべて固定長の配列で持ち、ゲーム中にメモリ確保をしない
+// Game（SFML版）はこのクラスに操作を渡し、状態を描画するだけ
+
+// Nextの並び（固定長のリングバッファ。std::deque と違ってメモリ確保をしない）
+class NextQueue {
+public:
+    static const int CAPACITY = 8;
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    PieceType front() const { return items[head]; }
+    PieceType operator[](int i) const { return items[(head + i) % CAPACITY]; }
+    void push_back(PieceType p) { items[(head + count) % CAPACITY] = p; ++count; }
+    void pop_front() { head = (head + 1) % CAPACITY; --count; }
+    void clear() { head = 0; count = 0; }
+
+private:
+    std::array<PieceType, CAPACITY> items{};
+    int head = 0, count = 0;
+};
+
+// 直前に固定したピースの結果
+struct LockResult {
+    PieceType type;
+    int linesCleared = 0;
+    std::uint32_t clearedRows = 0;  // 消した行のビット列（ビット y = 消す前の行 y。消える行の表示などに使う）
+    bool perfectClear = false;      // ラインを消して盤面が空になった
+};
+
+// 1回の固定で相手に送る攻撃（ガベージの段数）。Tスピン・REN・B2B は Simulation が区別しないので数えない
+int attackOf(const LockResult& lock);
+
+// 統計
+struct SimStats {
+    std::uint64_t ticks = 0;        // 進めたティック数
+    std::uint64_t pieces = 0;       // 固定したピースの数
+    std::uint64_t lines = 0;        // 消したライン数
+};
+
+class Simulation {
+public:
+    static const int NEXT_COUNT = 5;         // 見えるネクストの数
+
+    Simulation();
+
+    void reset();                            // 新しいゲームを始める（bagは前のゲームの続きから）
+    void reset(std::uint32_t seed);          // bagのシードを指定して新しいゲームを始める（リプレイ用）
+    bool apply(Action action);               // 操作を1つ適用する（状態が変わったら true）
+    void tick();                             // 1ティック進める（gravity ティックごとに1段落ちる）
+    bool fall();                             // 重力で1段落とす。落とせなければ固定する（固定したら true）
+    // 対戦用：下から lines 段のガベージ（hole の列が空き）をせり上げる
+    // 操作中のピースが埋まったら上に逃がし、逃がせない・盤面からはみ出したらゲームオーバー（続けられたら true）
+    bool addGarbage(int lines, int hole);
+    // 対戦用：盤面はそのままで負けにする（置ける場所がない・投了など。以後の操作・ティックは何もしない）
+    void topOut() { gameOver = true; }
+
+    int gravity = 0;                         // 何ティックで1段落ちるか（0なら自然落下しない）
+
+    // ---- 状態の読み出し ----
+    const Board& board() const { return field; }
+    const Piece& current() const { return currentPiece; }
+    int dropDistance() const;                // 現在のピースが何段下まで落ちられるか（ゴースト表示用）
+    const NextQueue& next() const { return nextQueue; }
+    std::optional<PieceType> hold() const { return holdPiece; }
+    bool holdUsed() const { return holdLocked; }
+    bool isGameOver() const { return gameOver; }
+    const LockResult& lastLock() const { return lastLockResult; }
+    const SimStats& stats() const { return counters; }
+    std::uint32_t seed() const { return bag.seed(); } // 最後に指定したbagのシード
+    const Bag& currentBag() const { return bag; }     // Nextの最後のピースまでで、今の袋から何が出たか（中身の順番は見ないこと）
+    std::uint64_t spawnCount() const { return spawned; } // ピースを出した回数（固定・ホールド・リセットで増える）
+
+private:
+    Board field;                             // 盤面（フィールド）
+    Bag bag;                                 // 7種1巡の袋
+    Piece currentPiece;                      // 現在操作中のピース
+    NextQueue nextQueue;                     // Next表示用のキュー
+    std::optional<PieceType> holdPiece;      // Holdに入っているピースの種類
+    bool holdLocked = false;                 // このピースでHoldを使ったか
+    bool gameOver = false;                   // 出現位置が埋まっていてピースを出せなかった（または topOut）
+    int fallCounter = 0;                     // 自然落下までの残りティック
+    std::uint64_t spawned = 0;               // ピースを出した回数
+    LockResult lastLockResult{ PieceType::T, 0, 0 };
+    SimStats counters;
+
+    void lock();                             // 現在のピースを固定し、ラインを消して次を出す
+    void spawn(PieceType type);              // 新しいピースを出現位置に出す
+    PieceType takeNext();                    // Nextの先頭を取り出し、bagから1つ補充する
+    void doHold();
+};
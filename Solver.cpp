@@ -0,0 +1,227 @@
+#include "Solver.hpp"
+#include "Piece.hpp"
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <tuple>
+
+// 1回のパフェで置くピース（＋ホールドに残る1個）がすべて Zobrist のネクストの表に収まること
+static_assert(PcSolver::MAX_HEIGHT * Board::WIDTH / 4 + 1 <= zobrist::MAX_QUEUE,
+              "zobrist::MAX_QUEUE must cover every piece a perfect clear can use");
+
+namespace {
+    // PcSolver::PcField の一番上の行が、Board の何行目にあたるか
+    const int FIELD_TOP = Board::HEIGHT - PcSolver::MAX_HEIGHT;
+
+    // 下から height 段の中にあるブロック数
+    int countFilled(const Board& board, int height) {
+        int filled = 0;
+        for (int y = Board::HEIGHT - height; y < Board::HEIGHT; ++y)
+            filled += static_cast<int>(std::bitset<16>(board.rows[y]).count());
+        return filled;
+    }
+
+    // 手順を決まった順番に並べるための比較（スレッドの実行順で結果の順番が変わらないようにする）
+    bool placementLess(const Placement& a, const Placement& b) {
+        return std::make_tuple(static_cast<int>(a.type), static_cast<int>(a.rotation), a.x, a.y, a.hold)
+             < std::make_tuple(static_cast<int>(b.type), static_cast<int>(b.rotation), b.x, b.y, b.hold);
+    }
+}
+
+// 列で区切られた空きマスの数が4の倍数になっているかを調べる
+// 下から height 段すべてが埋まっている列があると、その左右は別々に埋めるしかないため
+// rowOf(y) は下から height 段の y 番目（上から）の行
+template <class RowOf>
+static bool columnsDivisible(RowOf rowOf, int height) {
+    int empty = 0;
+    for (int x = 0; x < Board::WIDTH; ++x) {
+        int columnEmpty = 0;
+        for (int y = 0; y < height; ++y)
+            if (!((rowOf(y) >> x) & 1u)) ++columnEmpty;
+        if (columnEmpty == 0) {
+            if (empty % 4 != 0) return false;
+            empty = 0;
+        }
+        empty += columnEmpty;
+    }
+    return empty % 4 == 0;
+}
+
+bool isPcPossible(const Board& board, int height) {
+    return columnsDivisible([&](int y) { return board.rows[Board::HEIGHT - height + y]; }, height);
+}
+
+bool isPcPossible(const PcSolver::PcField& field, int height) {
+    return columnsDivisible([&](int y) { return field.row(PcSolver::MAX_HEIGHT - height + y); }, height);
+}
+
+// パフェを狙う段より上にはみ出す置き方を取り除く
+int filterByHeight(Placement* list, int count, int height) {
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        const Orientation& o = orientationOf(list[i].type, list[i].rotation);
+        if (list[i].y + o.minY >= Board::HEIGHT - height) list[kept++] = list[i];
+    }
+    return kept;
+}
+
+// ==================== PcSolver クラス ====================
+PcSolver::PcSolver(unsigned threadCount, std::size_t tableMegabytes) : pool(threadCount), table(tableMegabytes) {}
+
+// 置換表のキー：盤面（64ビットそのもの）を混ぜた値に、ホールドとネクストの位置を混ぜる
+std::uint64_t PcSolver::nodeKey(const Node& node) const {
+    int holdIndex = node.hold ? 1 + static_cast<int>(*node.hold) : 0;
+    std::uint64_t state = node.field.bits;
+    assert(node.index < zobrist::MAX_QUEUE);
+    return zobrist::splitmix64(state) ^ zobrist::HOLD_KEYS[holdIndex] ^ zobrist::QUEUE_KEYS[node.index] ^ sequenceKey;
+}
+
+// パフェになる手順をすべて探す
+std::vector<Solution> PcSolver::solve(const PcProblem& problem) {
+    results.clear();
+    nodes = 0;
+    startTime = std::chrono::steady_clock::now();
+    firstSolution = -1.0;
+
+    // 現在のピースとネクストを1列に並べる
+    pieces.clear();
+    pieces.push_back(problem.current);
+    pieces.insert(pieces.end(), problem.queue.begin(), problem.queue.end());
+    // 置換表のキーはネクストの位置で区別するので、zobrist::MAX_QUEUE 個を超える分は使わない
+    // （パフェに要るのは多くても MAX_HEIGHT * WIDTH / 4 + 1 個なので、切り捨てても解は変わらない）
+    if (pieces.size() > static_cast<std::size_t>(zobrist::MAX_QUEUE)) pieces.resize(zobrist::MAX_QUEUE);
+
+    // 前の solve の結果は使わない（置換表は世代が違うものを見つからない扱いにする）
+    table.newSearch();
+
+    // 探索できる段数を超えるか、パフェを狙う段より上にブロックがあれば不可能
+    if (problem.height < 1 || problem.height > MAX_HEIGHT) return {};
+    for (int y = 0; y < Board::HEIGHT - problem.height; ++y)
+        if (problem.field.rows[y] != 0) return {};
+
+    // 空きマスの数から必要なピース数を決める
+    int empty = problem.height * Board::WIDTH - countFilled(problem.field, problem.height);
+    if (empty <= 0 || empty % 4 != 0) return {};
+    piecesNeeded = empty / 4;
+    if (!isPcPossible(problem.field, problem.height)) return {};
+
+    // 同じ盤面・ネクストでも、狙う段数（と必要なピース数）が違えば別の問題なので、キーに混ぜる
+    std::uint64_t problemState = (static_cast<std::uint64_t>(problem.height) << 8) | static_cast<std::uint64_t>(piecesNeeded);
+    sequenceKey = zobrist::splitmix64(problemState);
+    for (std::size_t i = 0; i < pieces.size(); ++i)
+        sequenceKey ^= zobrist::PIECE_KEYS[i * 7 + static_cast<int>(pieces[i])];
+
+    Node root{ bottomRowsOf<PcField>(problem.field), problem.height, problem.hold, 0 };
+    spawn(root, Solution());
+    pool.wait();
+
+    std::sort(results.begin(), results.end(), [](const Solution& a, const Solution& b) {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), placementLess);
+    });
+    return results;
+}
+
+// 子局面をスレッドプールのタスクとして切り出す
+void PcSolver::spawn(const Node& node, const Solution& path) {
+    pool.submit([this, node = node, path = path]() mutable {
+        std::uint64_t localNodes = 0;
+        search(node, path, localNodes);
+        nodes.fetch_add(localNodes, std::memory_order_relaxed);
+    });
+}
+
+// 1局面から、置けるピースをすべて試す
+bool PcSolver::search(Node& node, Solution& path, std::uint64_t& localNodes) {
+    ++localNodes;
+
+    // 残りのピースが足りなければ打ち切り
+    int remaining = piecesNeeded - static_cast<int>(path.size());
+    int available = static_cast<int>(pieces.size()) - node.index + (node.hold ? 1 : 0);
+    if (available < remaining || node.index >= static_cast<int>(pieces.size())) return false;
+
+    // 別の順番で同じ局面を調べ終わっていて、パフェにならないと分かっていれば打ち切り
+    std::uint64_t key = nodeKey(node);
+    TTEntry entry;
+    if (table.probe(key, entry)) return false;
+
+    PieceType current = pieces[node.index];
+    bool live = false;
+
+    // 1) 現在のピースをそのまま置く
+    live |= expand(node, current, false, node.hold, node.index + 1, path, localNodes);
+
+    // 2) ホールドを使う
+    if (node.hold) {
+        // ホールドと同じ種類なら、入れ替えても同じ手順になるので省く
+        if (*node.hold != current)
+            live |= expand(node, *node.hold, true, current, node.index + 1, path, localNodes);
+    }
+    else if (node.index + 1 < static_cast<int>(pieces.size())) {
+        // 初回ホールド：現在のピースをホールドし、ネクストの先頭を置く
+        live |= expand(node, pieces[node.index + 1], true, current, node.index + 2, path, localNodes);
+    }
+
+    // パフェにならないと確定した局面だけを覚える
+    if (!live) {
+        entry.depth = static_cast<std::uint16_t>(remaining);
+        table.store(key, entry);
+    }
+    return live;
+}
+
+// 指定した種類のピースを置ける位置すべてについて、子局面を調べる
+// 子局面は node.field に置いて消して調べ、置く前の値（64ビット1つ）に戻す
+bool PcSolver::expand(Node& node, PieceType type, bool usedHold, std::optional<PieceType> nextHold, int nextIndex,
+                      Solution& path, std::uint64_t& localNodes) {
+    // 手生成は Board を使うので、下の段だけを書き込んだ盤面を作る（手生成は rows しか見ない）
+    Board board;
+    for (int y = 0; y < MAX_HEIGHT; ++y) board.rows[FIELD_TOP + y] = node.field.row(y);
+
+    bool live = false;
+    // 回転入れも含めて、実際に到達できる置き場所だけを試す
+    MoveGenerator gen;
+    Placement list[MoveGenerator::MAX_PLACEMENTS];
+    int n = filterByHeight(list, gen.generate(board, type, list), node.height);
+
+    // 戻し先
+    const PcField field = node.field;
+    const int height = node.height;
+    const std::optional<PieceType> hold = node.hold;
+    const int index = node.index;
+    for (int i = 0; i < n; ++i) {
+        Placement placement = list[i];
+        placement.hold = usedHold;
+
+        // 実際のゲームと同じく、置いてからラインを消す
+        node.field.place(orientationOf(type, placement.rotation), placement.x, placement.y - FIELD_TOP);
+        node.height = height - Board::countLines(node.field.clearLines());
+        node.hold = nextHold;
+        node.index = nextIndex;
+
+        path.push_back(placement);
+        if (node.height == 0) {
+            // 全部消えた＝パフェ
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (results.empty())
+                firstSolution = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            results.push_back(path);
+            live = true;
+        }
+        else if (static_cast<int>(path.size()) < piecesNeeded && isPcPossible(node.field, node.height)) {
+            // 残りが多く、手の空いているワーカーがいれば別タスクにする（タスクには局面のコピーを渡す）
+            if (piecesNeeded - static_cast<int>(path.size()) > 2 && pool.hasIdleWorker()) {
+                spawn(node, path);
+                live = true; // 結果はまだ分からない
+            }
+            else {
+                live |= search(node, path, localNodes);
+            }
+        }
+        path.pop_back();
+        node.field = field;
+    }
+    node.height = height;
+    node.hold = hold;
+    node.index = index;
+    return live;
+}
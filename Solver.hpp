@@ -0,0 +1,92 @@
+#pragma once
+#include "BitBoard.hpp"
+#include "Board.hpp"
+#include "MoveGen.hpp"
+#include "PieceTable.hpp"
+#include "ThreadPool.hpp"
+#include "TranspositionTable.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// ==== パフェ（Perfect Clear）探索 ====
+// 盤面・現在のピース・ホールド・ネクストを受け取り、
+// 盤面をすべて消し切れる置き方の手順を全部列挙する
+// 探索中の盤面は下の MAX_HEIGHT 段だけを64ビット1つ（PcField）で持ち、置く・消す・戻すをレジスタだけで行う
+
+// パフェまでの手順（置いた順）
+using Solution = std::vector<Placement>;
+
+// 探索の入力（Game の nextQueue / holdPiece と同じものを渡す）
+struct PcProblem {
+    Board field;                            // 現在の盤面
+    PieceType current;                      // 操作中のピース
+    std::optional<PieceType> hold;          // ホールド中のピース（なければ空）
+    std::vector<PieceType> queue;           // ネクスト（先頭から順に出てくる）
+    int height = 4;                         // パフェを狙う段数（下から何段で消し切るか。PcSolver::MAX_HEIGHT まで）
+};
+
+// ==== パフェ探索クラス ====
+// 探索はワークスティーリング方式のスレッドプールで並列に行う
+// ・浅い手で、手の空いているワーカーがいれば子ノードをタスクとして切り出す
+// ・深い手はそのワーカーの中で深さ優先探索する
+// 置き方の順番が違うだけで同じ局面になることが多いので、
+// 「この先パフェにならない」と分かった局面は置換表に覚えて、全スレッドで共有する
+class PcSolver {
+public:
+    static const int MAX_HEIGHT = 6;        // 探索できる段数の上限（10×6 = 60マスが64ビットに収まる）
+    using PcField = BitBoard<Board::WIDTH, MAX_HEIGHT>;
+    static_assert(sizeof(PcField) == sizeof(std::uint64_t), "PcField must be a single 64-bit word");
+
+    // threadCount：0ならCPUのコア数を使う、tableMegabytes：置換表に使うメモリ量
+    explicit PcSolver(unsigned threadCount = 0, std::size_t tableMegabytes = 64);
+
+    // パフェになる手順をすべて返す（見つからなければ空）
+    std::vector<Solution> solve(const PcProblem& problem);
+
+    std::uint64_t nodeCount() const { return nodes.load(); } // 直前の solve で調べた局面数
+    double firstSolutionSeconds() const { return firstSolution; } // 直前の solve で最初の手順が見つかるまでの秒数（なければ -1）
+    unsigned threadCount() const { return pool.size(); }
+    TTStats tableStats() const { return table.stats(); }    // 置換表のヒット・ミス数など
+    TranspositionTable& transpositionTable() { return table; }
+
+private:
+    // 探索中の1局面（1つのタスクの中では1つの Node を使い回し、置く前の field を覚えておいて戻す）
+    struct Node {
+        PcField field;                      // 盤面の下から MAX_HEIGHT 段（それより上は常に空）
+        int height;                         // 残りの段数（ライン消去で減る）
+        std::optional<PieceType> hold;
+        int index;                          // 次に操作するピースの位置（pieces[index]）
+    };
+
+    ThreadPool pool;
+    TranspositionTable table;
+    std::vector<PieceType> pieces;          // 現在のピース + ネクスト
+    std::uint64_t sequenceKey = 0;          // 段数・必要なピース数・ネクストの並びのハッシュ（別の問題の結果と混ざらないようにする）
+    int piecesNeeded = 0;                   // パフェに必要なピース数
+    std::atomic<std::uint64_t> nodes{ 0 };
+
+    std::mutex resultMutex;
+    std::vector<Solution> results;
+    std::chrono::steady_clock::time_point startTime;
+    double firstSolution = -1.0;
+
+    // path はここまでの手順、node は今の局面（深さ優先探索の中では push/pop・置いて戻すで使い回す）
+    // 戻り値が false なら「この局面から先にパフェはない」と確定している
+    // （パフェが見つかった、または子局面を別タスクに切り出して結果がまだ分からないときは true）
+    bool search(Node& node, Solution& path, std::uint64_t& localNodes);
+    bool expand(Node& node, PieceType type, bool usedHold, std::optional<PieceType> nextHold, int nextIndex,
+                Solution& path, std::uint64_t& localNodes);
+    std::uint64_t nodeKey(const Node& node) const;          // 置換表のキー（盤面・ホールド・ネクストの位置）
+    void spawn(const Node& node, const Solution& path);  // 子局面を別タスクとして切り出す
+};
+
+// パフェが可能かどうかの簡易判定（列で区切られた空きマスの数が4の倍数か）
+bool isPcPossible(const Board& board, int height);
+bool isPcPossible(const PcSolver::PcField& field, int height);
+
+// 手生成の結果のうち、下から height 段の中に収まる置き方だけを残す（残った数を返す）
+int filterByHeight(Placement* list, int count, int height);
@@ -0,0 +1,1007 @@
+// ==== 標準入出力で局面を受け取り、置き方を返すサービス ====
+// 1行に1つの JSON を stdin から読み、答えを1行の JSON で stdout に書く（SFMLには依存しない）
+// ・"id" の付いた要求は、それぞれ独立した局面として扱い、複数のワーカースレッドで同時に解く
+//   答えには同じ "id" を付ける。終わった順に書くので、要求の順番とは限らない
+// ・"id" の付いていないメッセージは、Tetris Bot Protocol（TBP）と同じ流れの1つの対局として扱う
+//   （rules → ready、start / suggest / play / new_piece / stop / quit。既存の TBP のクライアントから動かせる）
+// 起動はスレッドを作るだけなので、ジョブごとに起動してもすぐ使える
+// パフェのデータベース（--pcdb）は、最初にパフェを調べる要求が来たときにメモリにマップする
+//
+// 使い方: SolverService [ワーカーのスレッド数（0ならコア数）] [--pcdb <pc.db>]
+//         SolverService --check  … TBP の座標の変換と、suggest → play → suggest の流れを確かめる（合わなければ終了コード1）
+//
+// 局面の書き方（"id" の要求・TBP の start）
+//   "board": 下の行から順に40行（20行より上は空であること）。1行は10マスで、null が空き、文字列がブロック（TBP と同じ）
+//   "field": "board" の代わりに PcDbBuild の問題ファイルと同じ文字列でもよい（上の行から '/' 区切り、'#' = ブロック）
+//   "current": 今のピース（省略したら "queue" の先頭が今のピース。TBP と同じ）
+//   "hold": ホールドのピースか null、"hold_used": 今のピースでもうホールドしたか（省略したら false）
+//   "queue": その後に来るピース（例：["I","O","T"]）
+//   "bag_state" または "randomizer": {"bag_state": [...]}: queue の後で今の袋に残っている種類（省略したら queue から推測する）
+//   "time_ms": 考える時間の上限（省略したら100。1ミリ秒単位に切り上げ、10分まで）
+//   "nodes": 評価する局面の数の上限（0 なら数えない。同じ局面には毎回同じ答えになる）
+//   そろった行（10マスすべて埋まった行）がある盤面は受け付けない（ふつうのゲームでは消えているはずなので）
+// 例：{"id":1,"field":"......####/.....#####","current":"T","hold":null,"queue":["I","O","S"],"nodes":50000}
+//
+// 答え
+//   {"id":1,"type":"suggestion","moves":[{"location":{"type":"T","orientation":"north","x":4,"y":1},"spin":"none",
+//    "hold":false,"inputs":["cw","left","hard_drop"]}],"move_info":{"source":"beam","depth":5,"nodes":49812,"ms":21.4}}
+//   location は TBP と同じ書き方：orientation は形で決まる向き（north = TBP の出現の向き）、x, y は SRS の回転の中心のマスで、
+//   y は一番下の行を 0 として上に数える（このゲームの Rotation・Piece::x, y との対応は TBP_POSES の表を使う）
+//   置ける場所がなければ "moves" は空、要求が読めなければ {"id":…,"type":"error","reason":"…"}
+#include "BagTracker.hpp"
+#include "Bot.hpp"
+#include "PcDatabase.hpp"
+#include "Piece.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+    const char PIECE_LETTERS[] = "TSZIOLJ";
+    const char* const ORIENTATION_NAMES[4] = { "north", "east", "south", "west" };
+    const int DEFAULT_TIME_MS = 100;
+    const int NODE_ONLY_TIME_MS = 10000;     // 局面数だけを指定されたときの時間の上限（止まらなくならないように）
+    const int MAX_TIME_MS = 600000;          // time_ms の上限（10分）
+    const double MAX_NODES = 1e15;           // nodes の上限（uint64_t に変換できる範囲に収める）
+    const int TBP_ROWS = 40;                 // TBP の盤面の行数
+
+    // ==================== TBP の座標 ====================
+    // TBP の location は y が上向き（一番下の行が 0）で、向きは形で決まる名前（north = 出現の向き）、x, y は SRS の回転の中心のマス
+    // このゲームの形（PieceTable.hpp）は y が下向きの座標で書かれているので、Spawn は TBP の south（Tミノならとがった側が下）にあたる
+    // また基準のマス (Piece::x, Piece::y) は、I・O では回転の中心と一致しない
+    // そこで (種類, Rotation) ごとに、同じマスを埋める TBP の向きと、基準のマスから中心までのずれを表にしておき、
+    // 答えを書くとき（suggestion）も、置いた場所を読むとき（play）もこの表を使う
+
+    // TBP の north の形（y が上向き、回転の中心が (0,0)。並びは PieceType と同じ）
+    constexpr std::array<std::array<Cell, 4>, 7> TBP_NORTH = { {
+        { { {0,0}, {-1,0}, {1,0}, {0,1} } },  // T
+        { { {0,0}, {-1,0}, {0,1}, {1,1} } },  // S
+        { { {0,0}, {1,0}, {0,1}, {-1,1} } },  // Z
+        { { {0,0}, {-1,0}, {1,0}, {2,0} } },  // I
+        { { {0,0}, {1,0}, {0,1}, {1,1} } },   // O
+        { { {0,0}, {-1,0}, {1,0}, {1,1} } },  // L
+        { { {0,0}, {-1,0}, {1,0}, {-1,1} } }  // J
+    } };
+
+    // TBP の向き o（north から o 回だけ右回転 (x,y) -> (y,-x)）の形
+    constexpr std::array<Cell, 4> tbpCells(int type, int o) {
+        std::array<Cell, 4> cells = TBP_NORTH[type];
+        for (Cell& c : cells)
+            for (int k = 0; k < o; ++k) c = Cell{ c.y, -c.x };
+        return cells;
+    }
+
+    // (種類, Rotation) に対応する TBP の向きと、中心の位置
+    // 中心 = (Piece::x + dx, (Board::HEIGHT - 1 - Piece::y) + dy)（後ろは TBP の y）
+    struct TbpPose {
+        int orientation;                     // ORIENTATION_NAMES の添字（見つからなければ -1）
+        int dx, dy;
+    };
+
+    // Rotation r の形を y 上向きにしたものが、TBP の向き o の形を (dx, dy) ずらしたものと同じマスになるか
+    constexpr bool matchPose(int t, int r, int o, TbpPose& pose) {
+        const Orientation& ours = ORIENTATIONS[t][r];
+        std::array<Cell, 4> theirs = tbpCells(t, o);
+        int ourMinX = ours.cells[0].x, ourMinY = -ours.cells[0].y, tbpMinX = theirs[0].x, tbpMinY = theirs[0].y;
+        for (int i = 1; i < 4; ++i) {
+            ourMinX = std::min(ourMinX, ours.cells[i].x);
+            ourMinY = std::min(ourMinY, -ours.cells[i].y);
+            tbpMinX = std::min(tbpMinX, theirs[i].x);
+            tbpMinY = std::min(tbpMinY, theirs[i].y);
+        }
+        int dx = ourMinX - tbpMinX, dy = ourMinY - tbpMinY;
+        for (const Cell& c : ours.cells) {
+            bool found = false;
+            for (const Cell& d : theirs) found = found || (d.x + dx == c.x && d.y + dy == -c.y);
+            if (!found) return false;
+        }
+        pose = TbpPose{ o, dx, dy };
+        return true;
+    }
+
+    // 形だけなら S・Z・I・O は2つ以上の向きに当てはまるので、回転の向きがそろう (r + 2) % 4 を先に試す
+    constexpr std::array<std::array<TbpPose, 4>, 7> buildTbpPoses() {
+        std::array<std::array<TbpPose, 4>, 7> table{};
+        for (int t = 0; t < 7; ++t)
+            for (int r = 0; r < 4; ++r) {
+                table[t][r] = TbpPose{ -1, 0, 0 };
+                for (int k = 0; k < 4; ++k)
+                    if (matchPose(t, r, (r + 2 + k) % 4, table[t][r])) break;
+            }
+        return table;
+    }
+
+    constexpr auto TBP_POSES = buildTbpPoses();
+
+    // どの種類でも、4つの Rotation が4つの TBP の向きに1つずつ対応する（play を読むときに逆向きに引けること）
+    constexpr bool tbpPosesAreOneToOne() {
+        for (int t = 0; t < 7; ++t)
+            for (int o = 0; o < 4; ++o) {
+                int count = 0;
+                for (int r = 0; r < 4; ++r) count += TBP_POSES[t][r].orientation == o;
+                if (count != 1) return false;
+            }
+        return true;
+    }
+    static_assert(tbpPosesAreOneToOne(), "every Rotation must map to its own TBP orientation");
+
+    struct TbpLocation {
+        int orientation;
+        int x, y;                            // 回転の中心（y は上向き）
+    };
+
+    TbpLocation tbpLocationOf(PieceType type, Rotation rotation, int x, int y) {
+        const TbpPose& pose = TBP_POSES[static_cast<int>(type)][static_cast<int>(rotation)];
+        return TbpLocation{ pose.orientation, x + pose.dx, Board::HEIGHT - 1 - y + pose.dy };
+    }
+
+    // TBP の location を Piece にする
+    Piece pieceOfTbp(PieceType type, const TbpLocation& loc) {
+        Piece piece(type);
+        for (int r = 0; r < 4; ++r) {
+            const TbpPose& pose = TBP_POSES[static_cast<int>(type)][r];
+            if (pose.orientation != loc.orientation) continue;
+            piece.rotation = static_cast<Rotation>(r);
+            piece.x = loc.x - pose.dx;
+            piece.y = Board::HEIGHT - 1 - (loc.y - pose.dy);
+        }
+        return piece;
+    }
+
+    // ==================== 小さな JSON の読み取り ====================
+    struct JsonValue {
+        enum Kind { Null, Bool, Number, String, Array, Object };
+        Kind kind = Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string text;                    // String の中身
+        std::vector<JsonValue> items;        // Array の要素、Object の値
+        std::vector<std::string> keys;       // Object のキー（items と同じ順）
+
+        const JsonValue* get(const char* key) const {
+            for (std::size_t i = 0; i < keys.size(); ++i)
+                if (keys[i] == key) return &items[i];
+            return nullptr;
+        }
+        bool isNull() const { return kind == Null; }
+    };
+
+    class JsonParser {
+    public:
+        JsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+        // 1つの値を読み、後ろに空白しか残っていなければ true
+        bool parseDocument(JsonValue& out) {
+            if (!parseValue(out, 0)) return false;
+            skipSpace();
+            return p == end;
+        }
+
+    private:
+        static const int MAX_NESTING = 32;
+        const char* p;
+        const char* end;
+
+        void skipSpace() {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+        }
+        bool literal(const char* word) {
+            std::size_t n = std::strlen(word);
+            if (static_cast<std::size_t>(end - p) < n || std::strncmp(p, word, n) != 0) return false;
+            p += n;
+            return true;
+        }
+
+        bool parseValue(JsonValue& out, int nesting) {
+            skipSpace();
+            if (p == end || nesting > MAX_NESTING) return false;
+            switch (*p) {
+            case '{': return parseObject(out, nesting);
+            case '[': return parseArray(out, nesting);
+            case '"': out.kind = JsonValue::String; return parseString(out.text);
+            case 't': out.kind = JsonValue::Bool; out.boolean = true; return literal("true");
+            case 'f': out.kind = JsonValue::Bool; out.boolean = false; return literal("false");
+            case 'n': out.kind = JsonValue::Null; return literal("null");
+            default: return parseNumber(out);
+            }
+        }
+
+        bool parseNumber(JsonValue& out) {
+            std::string digits;
+            while (p < end && (std::strchr("+-.eE", *p) || (*p >= '0' && *p <= '9'))) digits += *p++;
+            if (digits.empty()) return false;
+            char* stop = nullptr;
+            out.kind = JsonValue::Number;
+            out.number = std::strtod(digits.c_str(), &stop);
+            return *stop == '\0';
+        }
+
+        bool parseString(std::string& out) {
+            ++p; // "
+            out.clear();
+            while (p < end && *p != '"') {
+                char c = *p++;
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+                if (p == end) return false;
+                c = *p++;
+                switch (c) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u':
+                    // ピースの名前などは ASCII だけなので、それ以外の文字は '?' にする
+                    if (end - p < 4) return false;
+                    {
+                        long code = std::strtol(std::string(p, p + 4).c_str(), nullptr, 16);
+                        out += code < 128 ? static_cast<char>(code) : '?';
+                    }
+                    p += 4;
+                    break;
+                default: out += c; break; // \" \\ \/
+                }
+            }
+            if (p == end) return false;
+            ++p; // "
+            return true;
+        }
+
+        bool parseArray(JsonValue& out, int nesting) {
+            ++p; // [
+            out.kind = JsonValue::Array;
+            skipSpace();
+            if (p < end && *p == ']') {
+                ++p;
+                return true;
+            }
+            for (;;) {
+                out.items.emplace_back();
+                if (!parseValue(out.items.back(), nesting + 1)) return false;
+                skipSpace();
+                if (p == end) return false;
+                if (*p == ']') {
+                    ++p;
+                    return true;
+                }
+                if (*p++ != ',') return false;
+            }
+        }
+
+        bool parseObject(JsonValue& out, int nesting) {
+            ++p; // {
+            out.kind = JsonValue::Object;
+            skipSpace();
+            if (p < end && *p == '}') {
+                ++p;
+                return true;
+            }
+            for (;;) {
+                skipSpace();
+                if (p == end || *p != '"') return false;
+                out.keys.emplace_back();
+                if (!parseString(out.keys.back())) return false;
+                skipSpace();
+                if (p == end || *p++ != ':') return false;
+                out.items.emplace_back();
+                if (!parseValue(out.items.back(), nesting + 1)) return false;
+                skipSpace();
+                if (p == end) return false;
+                if (*p == '}') {
+                    ++p;
+                    return true;
+                }
+                if (*p++ != ',') return false;
+            }
+        }
+    };
+
+    // ---- JSON を書く ----
+    void appendf(std::string& out, const char* fmt, ...) {
+        char buffer[256];
+        va_list args;
+        va_start(args, fmt);
+        int n = std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+        va_end(args);
+        if (n > 0) out.append(buffer, static_cast<std::size_t>(std::min(n, static_cast<int>(sizeof(buffer)) - 1)));
+    }
+
+    void appendString(std::string& out, const std::string& text) {
+        out += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) appendf(out, "\\u%04x", c);
+            else out += c;
+        }
+        out += '"';
+    }
+
+    // 要求の "id" をそのまま返す（数か文字列）
+    void appendId(std::string& out, const JsonValue& id) {
+        if (id.kind == JsonValue::String) appendString(out, id.text);
+        else if (id.kind == JsonValue::Number) appendf(out, "%.17g", id.number);
+        else out += "null";
+    }
+
+    // ==================== 局面 ====================
+    struct Position {
+        Board board;
+        PieceType current = PieceType::T;
+        std::optional<PieceType> hold;
+        bool holdUsed = false;
+        std::vector<PieceType> queue;        // 今のピースの後に来る順
+        std::optional<PieceSet> bagRemaining; // queue の後で今の袋に残っている種類（分からなければ空）
+    };
+
+    bool pieceOf(const JsonValue* v, PieceType& type) {
+        if (!v || v->kind != JsonValue::String || v->text.size() != 1) return false;
+        const char* p = std::strchr(PIECE_LETTERS, v->text[0]);
+        if (v->text[0] == '\0' || !p) return false;
+        type = static_cast<PieceType>(p - PIECE_LETTERS);
+        return true;
+    }
+
+    bool piecesOf(const JsonValue* v, std::vector<PieceType>& out) {
+        out.clear();
+        if (!v) return true;
+        if (v->kind != JsonValue::Array) return false;
+        for (const JsonValue& item : v->items) {
+            PieceType type;
+            if (!pieceOf(&item, type)) return false;
+            out.push_back(type);
+        }
+        return true;
+    }
+
+    // そろった行があれば、その行（下から何行目か）をエラーにする
+    // 固定するまで消えないので、受け付けると置ける場所や消えるライン数の計算が実際のゲームと合わなくなる
+    bool hasFullRow(const Board& board, std::string& error) {
+        for (int y = 0; y < Board::HEIGHT; ++y) {
+            if (board.rows[y] != Board::FULL_ROW) continue;
+            error = "row " + std::to_string(Board::HEIGHT - 1 - y) + " is full";
+            return true;
+        }
+        return false;
+    }
+
+    // TBP の盤面（下の行から40行、null が空き）
+    bool boardOfRows(const JsonValue& rows, Board& board, std::string& error) {
+        if (rows.kind != JsonValue::Array || rows.items.size() > static_cast<std::size_t>(TBP_ROWS)) {
+            error = "board must be an array of at most 40 rows";
+            return false;
+        }
+        for (std::size_t r = 0; r < rows.items.size(); ++r) {
+            const JsonValue& row = rows.items[r];
+            if (row.kind != JsonValue::Array || row.items.size() != static_cast<std::size_t>(Board::WIDTH)) {
+                error = "each board row must have 10 cells";
+                return false;
+            }
+            for (int x = 0; x < Board::WIDTH; ++x) {
+                if (row.items[x].isNull()) continue;
+                if (r >= static_cast<std::size_t>(Board::HEIGHT)) {
+                    error = "blocks above row 20 are not supported";
+                    return false;
+                }
+                board.placeBlock(x, Board::HEIGHT - 1 - static_cast<int>(r), static_cast<std::uint8_t>(Board::GARBAGE));
+            }
+        }
+        return !hasFullRow(board, error);
+    }
+
+    // PcDbBuild と同じ書き方（上の行から '/' 区切り、盤面の一番下にそろえる）
+    bool boardOfField(const std::string& field, Board& board, std::string& error) {
+        if (field == "empty") return true;
+        std::vector<std::string> rows;
+        std::size_t start = 0;
+        for (;;) {
+            std::size_t slash = field.find('/', start);
+            rows.push_back(field.substr(start, slash == std::string::npos ? std::string::npos : slash - start));
+            if (slash == std::string::npos) break;
+            start = slash + 1;
+        }
+        if (rows.size() > static_cast<std::size_t>(Board::HEIGHT)) {
+            error = "field is taller than 20 rows";
+            return false;
+        }
+        int top = Board::HEIGHT - static_cast<int>(rows.size());
+        for (int r = 0; r < static_cast<int>(rows.size()); ++r) {
+            if (rows[r].size() != static_cast<std::size_t>(Board::WIDTH)) {
+                error = "each field row must have 10 cells";
+                return false;
+            }
+            for (int x = 0; x < Board::WIDTH; ++x)
+                if (rows[r][x] == '#') board.placeBlock(x, top + r, static_cast<std::uint8_t>(Board::GARBAGE));
+        }
+        return !hasFullRow(board, error);
+    }
+
+    // 要求（または TBP の start）から局面を作る
+    bool positionOf(const JsonValue& msg, Position& pos, std::string& error) {
+        pos = Position();
+        const JsonValue* board = msg.get("board");
+        const JsonValue* field = msg.get("field");
+        if (board && !boardOfRows(*board, pos.board, error)) return false;
+        if (!board && field) {
+            if (field->kind != JsonValue::String) {
+                error = "field must be a string";
+                return false;
+            }
+            if (!boardOfField(field->text, pos.board, error)) return false;
+        }
+
+        if (!piecesOf(msg.get("queue"), pos.queue)) {
+            error = "queue must be an array of piece letters";
+            return false;
+        }
+        if (const JsonValue* current = msg.get("current")) {
+            if (!pieceOf(current, pos.current)) {
+                error = "current must be a piece letter";
+                return false;
+            }
+        }
+        else {
+            // TBP と同じく、queue の先頭が今のピース
+            if (pos.queue.empty()) {
+                error = "no current piece";
+                return false;
+            }
+            pos.current = pos.queue.front();
+            pos.queue.erase(pos.queue.begin());
+        }
+
+        const JsonValue* hold = msg.get("hold");
+        if (hold && !hold->isNull()) {
+            PieceType type;
+            if (!pieceOf(hold, type)) {
+                error = "hold must be a piece letter or null";
+                return false;
+            }
+            pos.hold = type;
+        }
+        const JsonValue* holdUsed = msg.get("hold_used");
+        pos.holdUsed = holdUsed && holdUsed->kind == JsonValue::Bool && holdUsed->boolean;
+
+        const JsonValue* bag = msg.get("bag_state");
+        if (!bag) {
+            const JsonValue* randomizer = msg.get("randomizer");
+            if (randomizer) bag = randomizer->get("bag_state");
+        }
+        if (bag) {
+            std::vector<PieceType> remaining;
+            if (!piecesOf(bag, remaining)) {
+                error = "bag_state must be an array of piece letters";
+                return false;
+            }
+            PieceSet set = 0;
+            for (PieceType t : remaining) set |= pieceBit(t);
+            pos.bagRemaining = set;
+        }
+        return true;
+    }
+
+    // 時間と局面数の上限
+    struct Budget {
+        int timeMs = DEFAULT_TIME_MS;
+        std::uint64_t nodes = 0;
+    };
+
+    // 数を整数に変換する前に範囲に収める（範囲外の double を整数にキャストすると未定義動作になる）
+    // 時間は切り上げるので、1ミリ秒より短い指定でも 0 ミリ秒（すぐに打ち切り）にはならない
+    Budget budgetOf(const JsonValue& msg, const Budget& fallback) {
+        Budget budget = fallback;
+        const JsonValue* time = msg.get("time_ms");
+        const JsonValue* nodes = msg.get("nodes");
+        if (nodes && nodes->kind == JsonValue::Number && nodes->number > 0) {
+            budget.nodes = static_cast<std::uint64_t>(std::min(std::ceil(nodes->number), MAX_NODES));
+            if (!time) budget.timeMs = NODE_ONLY_TIME_MS;
+        }
+        if (time && time->kind == JsonValue::Number && time->number > 0)
+            budget.timeMs = static_cast<int>(std::min(std::ceil(time->number), static_cast<double>(MAX_TIME_MS)));
+        return budget;
+    }
+
+    // ==================== 1つの局面を解く ====================
+    // ワーカーごとに1つ持つ（BeamBot・MoveGenerator は同時に使えないので）
+    struct Solver {
+        BeamBot bot;
+        MoveGenerator gen;
+        PcProblem problem;
+        PcDbAnswer answer;
+    };
+
+    struct Answer {
+        bool found = false;
+        Placement placement{ PieceType::T, Rotation::Spawn, 0, 0 };
+        std::array<Action, MoveGenerator::MAX_PATH> actions{};
+        int actionCount = 0;
+        const char* source = "beam";
+        int depth = 0;
+        std::uint64_t nodes = 0;
+        double ms = 0.0;
+    };
+
+    // パフェのデータベースは、最初に使うときに開く（開けなければ以後は使わない）
+    class LazyPcDatabase {
+    public:
+        const char* path = nullptr;
+        const PcDatabase* get() {
+            if (!path) return nullptr;
+            std::call_once(opened, [this] { ready = database.open(path); });
+            return ready ? &database : nullptr;
+        }
+    private:
+        std::once_flag opened;
+        PcDatabase database;
+        bool ready = false;
+    };
+
+    // Advisor と同じく、低い段数から順に、ネクストの長い問題から調べる
+    bool lookupPc(const PcDatabase& db, Solver& s, const Position& pos, Answer& answer) {
+        if (pos.holdUsed) return false;
+        s.problem.field = pos.board;
+        s.problem.current = pos.current;
+        s.problem.hold = pos.hold;
+        for (s.problem.height = 1; s.problem.height <= PcDatabase::MAX_HEIGHT; ++s.problem.height) {
+            for (int count = static_cast<int>(pos.queue.size()); count >= 0; --count) {
+                s.problem.queue.assign(pos.queue.begin(), pos.queue.begin() + count);
+                if (!db.lookup(s.problem, s.answer) || !s.answer.solvable || s.answer.solution.empty()) continue;
+                answer.placement = s.answer.solution[0];
+                answer.actionCount = s.gen.findPath(pos.board, answer.placement, answer.actions.data());
+                if (answer.actionCount < 0) return false;
+                answer.found = true;
+                answer.source = "pcdb";
+                answer.depth = static_cast<int>(s.answer.solution.size());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Answer solve(Solver& s, const Position& pos, const Budget& budget, LazyPcDatabase& pcDatabase) {
+        auto start = std::chrono::steady_clock::now();
+        Answer answer;
+        const PcDatabase* db = pcDatabase.get();
+        if (!db || !lookupPc(*db, s, pos, answer)) {
+            // 見えている列の後ろの1個が袋から決まるなら、それも読む
+            std::vector<PieceType> queue(pos.queue);
+            BagTracker tracker;
+            if (pos.bagRemaining) tracker.knowRemaining(*pos.bagRemaining);
+            else for (PieceType t : pos.queue) tracker.observe(t);
+            PieceSet following = 0;
+            tracker.possiblePieces(&following, 1);
+            for (int t = 0; t < BagTracker::BAG_SIZE; ++t)
+                if (following == pieceBit(static_cast<PieceType>(t))) queue.push_back(static_cast<PieceType>(t));
+
+            s.bot.budget = std::chrono::milliseconds(budget.timeMs);
+            s.bot.nodeBudget = budget.nodes;
+            BotDecision d = s.bot.decide(pos.board, pos.current, pos.hold, pos.holdUsed, queue.data(),
+                                         static_cast<int>(queue.size()));
+            answer.found = d.found;
+            answer.placement = d.placement;
+            answer.actions = d.actions;
+            answer.actionCount = d.actionCount;
+            answer.depth = d.depth;
+            answer.nodes = d.nodes;
+        }
+        answer.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return answer;
+    }
+
+    const char* inputName(Action a) {
+        switch (a) {
+        case Action::MoveLeft:  return "left";
+        case Action::MoveRight: return "right";
+        case Action::SoftDrop:  return "soft_drop";
+        case Action::HardDrop:  return "hard_drop";
+        case Action::RotateCW:  return "cw";
+        case Action::RotateCCW: return "ccw";
+        case Action::Hold:      return "hold";
+        default:                return "none";
+        }
+    }
+
+    // {"type":"suggestion",...}（id があれば先頭に付ける）
+    std::string suggestionJson(const JsonValue* id, const Answer& a) {
+        std::string out = "{";
+        if (id) {
+            out += "\"id\":";
+            appendId(out, *id);
+            out += ',';
+        }
+        out += "\"type\":\"suggestion\",\"moves\":[";
+        if (a.found) {
+            const Placement& p = a.placement;
+            static const char* const SPIN_NAMES[3] = { "none", "mini", "full" };
+            TbpLocation loc = tbpLocationOf(p.type, p.rotation, p.x, p.y);
+            appendf(out, "{\"location\":{\"type\":\"%c\",\"orientation\":\"%s\",\"x\":%d,\"y\":%d},\"spin\":\"%s\",\"hold\":%s,\"inputs\":[",
+                    PIECE_LETTERS[static_cast<int>(p.type)], ORIENTATION_NAMES[loc.orientation],
+                    loc.x, loc.y, SPIN_NAMES[static_cast<int>(p.spin)], p.hold ? "true" : "false");
+            for (int i = 0; i < a.actionCount; ++i) appendf(out, "%s\"%s\"", i ? "," : "", inputName(a.actions[i]));
+            out += "]}";
+        }
+        appendf(out, "],\"move_info\":{\"source\":\"%s\",\"depth\":%d,\"nodes\":%llu,\"ms\":%.3f}}", a.source, a.depth,
+                static_cast<unsigned long long>(a.nodes), a.ms);
+        return out;
+    }
+
+    std::string errorJson(const JsonValue* id, const std::string& reason) {
+        std::string out = "{";
+        if (id) {
+            out += "\"id\":";
+            appendId(out, *id);
+            out += ',';
+        }
+        out += "\"type\":\"error\",\"reason\":";
+        appendString(out, reason);
+        out += '}';
+        return out;
+    }
+
+    // ==================== サービス本体 ====================
+    class Service {
+    public:
+        explicit Service(unsigned threads) : pool(threads), maxInFlight(static_cast<int>(pool.size()) * 4) {
+            for (unsigned i = 0; i < pool.size(); ++i) solvers.push_back(std::make_unique<Solver>());
+        }
+
+        LazyPcDatabase pcDatabase;
+
+        // 1行を処理する。quit なら false
+        bool handle(const std::string& line) {
+            if (line.find_first_not_of(" \t\r\n") == std::string::npos) return true;
+            auto msg = std::make_shared<JsonValue>();
+            JsonParser parser(line.data(), line.data() + line.size());
+            if (!parser.parseDocument(*msg) || msg->kind != JsonValue::Object) {
+                write(errorJson(nullptr, "malformed JSON"));
+                return true;
+            }
+            if (msg->get("id")) {
+                submit(msg);
+                return true;
+            }
+            return handleSession(*msg);
+        }
+
+        // 流れている要求がすべて答え終わるまで待つ
+        void finish() { pool.wait(); }
+
+        std::uint64_t answered() const { return answeredCount.load(); }
+
+        // 確かめる用（--check）：出力を stdout の代わりにここにためる・TBP の対局の盤面を見る
+        std::vector<std::string>* capture = nullptr;
+        const Board& sessionBoard() const { return session.board; }
+
+    private:
+        ThreadPool pool;
+        std::vector<std::unique_ptr<Solver>> solvers; // ワーカーの番号ごと
+        Solver sessionSolver;                        // TBP の対局用（読み込みのスレッドで解く）
+        std::mutex outputMutex;
+        std::atomic<std::uint64_t> answeredCount{ 0 };
+
+        // 同時に流す要求の数の上限（読み込みだけが先に進んでメモリを使い切らないように）
+        const int maxInFlight;
+        int inFlight = 0;
+        std::mutex flightMutex;
+        std::condition_variable flightDone;
+
+        // ---- TBP の対局の状態 ----
+        bool started = false;
+        Position session;
+        std::vector<PieceType> sessionQueue; // TBP と同じく、先頭が今のピース
+        Budget sessionBudget;
+
+        void write(const std::string& json) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            answeredCount.fetch_add(1, std::memory_order_relaxed);
+            if (capture) {
+                capture->push_back(json);
+                return;
+            }
+            std::fwrite(json.data(), 1, json.size(), stdout);
+            std::fputc('\n', stdout);
+            std::fflush(stdout);
+        }
+
+        // "id" の付いた要求：局面を読んでワーカーに渡す（答えはワーカーが書く）
+        void submit(std::shared_ptr<JsonValue> msg) {
+            {
+                std::unique_lock<std::mutex> lock(flightMutex);
+                flightDone.wait(lock, [this] { return inFlight < maxInFlight; });
+                ++inFlight;
+            }
+            pool.submit([this, msg] {
+                const JsonValue* id = msg->get("id");
+                Position pos;
+                std::string error;
+                if (positionOf(*msg, pos, error))
+                    write(suggestionJson(id, solve(*solvers[pool.currentWorker()], pos, budgetOf(*msg, Budget()), pcDatabase)));
+                else
+                    write(errorJson(id, error));
+                {
+                    std::lock_guard<std::mutex> lock(flightMutex);
+                    --inFlight;
+                }
+                flightDone.notify_one();
+            });
+        }
+
+        bool handleSession(const JsonValue& msg) {
+            const JsonValue* type = msg.get("type");
+            std::string name = type && type->kind == JsonValue::String ? type->text : "";
+            if (name == "quit") return false;
+            if (name == "rules") {
+                write("{\"type\":\"ready\"}");
+            }
+            else if (name == "start") {
+                std::string error;
+                if (!positionOf(msg, session, error)) {
+                    started = false;
+                    write(errorJson(nullptr, error));
+                    return true;
+                }
+                sessionQueue.assign(1, session.current);
+                sessionQueue.insert(sessionQueue.end(), session.queue.begin(), session.queue.end());
+                sessionBudget = budgetOf(msg, Budget());
+                started = true;
+            }
+            else if (name == "stop") {
+                started = false;
+            }
+            else if (name == "suggest") {
+                if (!started || sessionQueue.empty()) {
+                    write(errorJson(nullptr, started ? "no current piece" : "suggest before start"));
+                    return true;
+                }
+                session.current = sessionQueue.front();
+                session.queue.assign(sessionQueue.begin() + 1, sessionQueue.end());
+                write(suggestionJson(nullptr, solve(sessionSolver, session, sessionBudget, pcDatabase)));
+            }
+            else if (name == "play") {
+                std::string error;
+                if (!started || !play(msg, error)) write(errorJson(nullptr, started ? error : "play before start"));
+            }
+            else if (name == "new_piece") {
+                PieceType type;
+                if (!started || !pieceOf(msg.get("piece"), type)) {
+                    write(errorJson(nullptr, "new_piece needs a started game and a piece letter"));
+                    return true;
+                }
+                sessionQueue.push_back(type);
+                // 袋の残りが分かっていれば、来たピースを消す（空なら新しい袋から出たもの）
+                if (session.bagRemaining) {
+                    PieceSet remaining = *session.bagRemaining ? *session.bagRemaining : ALL_PIECES;
+                    if (remaining & pieceBit(type)) session.bagRemaining = static_cast<PieceSet>(remaining & ~pieceBit(type));
+                    else session.bagRemaining.reset(); // 7種1巡と合わないので、以後は推測に任せる
+                }
+            }
+            else {
+                write(errorJson(nullptr, "unknown message type"));
+            }
+            return true;
+        }
+
+        // TBP の play：置いたピースが今のピースと違えばホールドを使ったことになる
+        bool play(const JsonValue& msg, std::string& error) {
+            const JsonValue* move = msg.get("move");
+            const JsonValue* location = move ? move->get("location") : nullptr;
+            PieceType type;
+            const JsonValue* orientation = location ? location->get("orientation") : nullptr;
+            const JsonValue* x = location ? location->get("x") : nullptr;
+            const JsonValue* y = location ? location->get("y") : nullptr;
+            if (!location || !pieceOf(location->get("type"), type) || !orientation || !x || !y ||
+                x->kind != JsonValue::Number || y->kind != JsonValue::Number) {
+                error = "play needs move.location {type, orientation, x, y}";
+                return false;
+            }
+            TbpLocation loc{ -1, 0, 0 };
+            for (int o = 0; o < 4; ++o)
+                if (orientation->text == ORIENTATION_NAMES[o]) loc.orientation = o;
+            if (loc.orientation < 0 || sessionQueue.empty()) {
+                error = loc.orientation < 0 ? "unknown orientation" : "no current piece";
+                return false;
+            }
+            // 盤面から大きく外れた数は、整数にキャストする前に弾く（どのみち置けない）
+            if (std::floor(x->number) != x->number || std::floor(y->number) != y->number || std::fabs(x->number) > TBP_ROWS ||
+                std::fabs(y->number) > TBP_ROWS) {
+                error = "move does not fit on the board";
+                return false;
+            }
+            loc.x = static_cast<int>(x->number);
+            loc.y = static_cast<int>(y->number);
+
+            Piece piece = pieceOfTbp(type, loc);
+            for (const Cell& c : piece.getAbsolutePositions()) {
+                if (c.x < 0 || c.x >= Board::WIDTH || c.y < 0 || c.y >= Board::HEIGHT || session.board.isOccupied(c.x, c.y)) {
+                    error = "move does not fit on the board";
+                    return false;
+                }
+            }
+
+            // 置いたピースを列から取り除く
+            if (type == sessionQueue.front()) {
+                sessionQueue.erase(sessionQueue.begin());
+            }
+            else if (session.hold && *session.hold == type) {
+                session.hold = sessionQueue.front();
+                sessionQueue.erase(sessionQueue.begin());
+            }
+            else if (!session.hold && sessionQueue.size() > 1 && sessionQueue[1] == type) {
+                session.hold = sessionQueue.front();
+                sessionQueue.erase(sessionQueue.begin(), sessionQueue.begin() + 2);
+            }
+            else {
+                error = "played piece is neither current nor reachable with hold";
+                return false;
+            }
+            piece.placeAndClear(session.board);
+            session.holdUsed = false;
+            return true;
+        }
+    };
+}
+
+// ==================== TBP の座標の確認（--check） ====================
+namespace {
+    int failures = 0;
+
+    void expect(bool ok, const char* what) {
+        if (ok) return;
+        ++failures;
+        std::printf("FAILED: %s\n", what);
+    }
+
+    // TBP の location が埋めるマス（TBP の形の定義だけから求める。y は上向き）
+    std::array<Cell, 4> cellsOfLocation(const JsonValue& location) {
+        PieceType type = PieceType::T;
+        pieceOf(location.get("type"), type);
+        int o = 0;
+        for (int k = 0; k < 4; ++k)
+            if (location.get("orientation")->text == ORIENTATION_NAMES[k]) o = k;
+        std::array<Cell, 4> cells = tbpCells(static_cast<int>(type), o);
+        for (Cell& c : cells) {
+            c.x += static_cast<int>(location.get("x")->number);
+            c.y += static_cast<int>(location.get("y")->number);
+        }
+        return cells;
+    }
+
+    // 1. 表の変換：どの置き方も、TBP に書いて読み直すと元に戻り、TBP の形の定義で同じマスを埋める
+    void checkPoseTable() {
+        bool roundTrip = true, sameCells = true;
+        for (int t = 0; t < 7; ++t)
+            for (int r = 0; r < 4; ++r)
+                for (int x = -2; x < Board::WIDTH + 2; ++x)
+                    for (int y = -2; y < Board::HEIGHT + 2; ++y) {
+                        Piece piece(static_cast<PieceType>(t));
+                        piece.rotation = static_cast<Rotation>(r);
+                        piece.x = x;
+                        piece.y = y;
+                        TbpLocation loc = tbpLocationOf(piece.type, piece.rotation, x, y);
+                        Piece back = pieceOfTbp(piece.type, loc);
+                        roundTrip = roundTrip && back.rotation == piece.rotation && back.x == x && back.y == y;
+                        std::array<Cell, 4> theirs = tbpCells(t, loc.orientation);
+                        for (const Cell& c : piece.getAbsolutePositions()) {
+                            bool found = false;
+                            for (const Cell& d : theirs)
+                                found = found || (loc.x + d.x == c.x && loc.y + d.y == Board::HEIGHT - 1 - c.y);
+                            sameCells = sameCells && found;
+                        }
+                    }
+        expect(roundTrip, "Rotation/origin -> TBP location -> Rotation/origin is not the identity");
+        expect(sameCells, "TBP location does not cover the same cells as the piece");
+    }
+
+    // 2. TBP の対局：suggest の答えをそのまま play に返し、盤面が TBP の形で置いたときと同じになるかを続けて確かめる
+    void checkSession() {
+        const int PIECES = 100;
+        Service service(1);
+        std::vector<std::string> out;
+        service.capture = &out;
+
+        // TBP のクライアントが送ってくる、床に置いた O（north, 中心 (0,0)）と T（north, 中心 (4,0)、とがった側が上）は置ける
+        service.handle("{\"type\":\"start\",\"hold\":null,\"queue\":[\"O\",\"T\",\"I\"],\"board\":[]}");
+        service.handle("{\"type\":\"play\",\"move\":{\"location\":{\"type\":\"O\",\"orientation\":\"north\",\"x\":0,\"y\":0}}}");
+        service.handle("{\"type\":\"play\",\"move\":{\"location\":{\"type\":\"T\",\"orientation\":\"north\",\"x\":4,\"y\":0}}}");
+        // 床より下にはみ出す I は置けない
+        service.handle("{\"type\":\"play\",\"move\":{\"location\":{\"type\":\"I\",\"orientation\":\"north\",\"x\":1,\"y\":-1}}}");
+        expect(out.size() == 1 && out[0].find("does not fit") != std::string::npos, "floor placements from a TBP client");
+        Board expected;
+        for (int x : { 0, 1, 3, 4, 5 }) expected.placeBlock(x, Board::HEIGHT - 1, static_cast<std::uint8_t>(Board::GARBAGE));
+        for (int x : { 0, 1, 4 }) expected.placeBlock(x, Board::HEIGHT - 2, static_cast<std::uint8_t>(Board::GARBAGE));
+        expect(service.sessionBoard().rows == expected.rows, "board after TBP floor placements");
+
+        // 置いては読む流れ（suggest → play → new_piece → suggest ...）
+        Bag bag(7);
+        std::string queue;
+        for (int i = 0; i < 6; ++i) queue += std::string(i ? "," : "") + "\"" + toString(bag.getNext()) + "\"";
+        out.clear();
+        service.handle("{\"type\":\"start\",\"hold\":null,\"queue\":[" + queue + "],\"board\":[],\"nodes\":2000}");
+        expected = Board();
+        int placed = 0;
+        for (; placed < PIECES; ++placed) {
+            out.clear();
+            service.handle("{\"type\":\"suggest\"}");
+            JsonValue answer;
+            JsonParser parser(out.empty() ? "" : out[0].data(), out.empty() ? "" : out[0].data() + out[0].size());
+            if (!parser.parseDocument(answer) || !answer.get("moves") || answer.get("moves")->items.empty()) break;
+            const JsonValue& move = answer.get("moves")->items[0];
+            std::array<Cell, 4> cells = cellsOfLocation(*move.get("location"));
+            bool inside = true, resting = false;
+            for (const Cell& c : cells) {
+                int y = Board::HEIGHT - 1 - c.y;
+                inside = inside && c.x >= 0 && c.x < Board::WIDTH && c.y >= 0 && !expected.isOccupied(c.x, y);
+                resting = resting || expected.isOccupied(c.x, y + 1);
+            }
+            expect(inside && resting, "suggested location is not a resting placement on the board");
+            for (const Cell& c : cells) expected.placeBlock(c.x, Board::HEIGHT - 1 - c.y, static_cast<std::uint8_t>(Board::GARBAGE));
+            expected.clearLines();
+
+            // 答えの location を、TBP のクライアントと同じく整数の座標で送り返す
+            const JsonValue& location = *move.get("location");
+            char play[160];
+            std::snprintf(play, sizeof(play),
+                          "{\"type\":\"play\",\"move\":{\"location\":{\"type\":\"%s\",\"orientation\":\"%s\",\"x\":%d,\"y\":%d}}}",
+                          location.get("type")->text.c_str(), location.get("orientation")->text.c_str(),
+                          static_cast<int>(location.get("x")->number), static_cast<int>(location.get("y")->number));
+            out.clear();
+            service.handle(play);
+            expect(out.empty(), "the service rejected its own suggestion");
+            expect(service.sessionBoard().rows == expected.rows, "board after play differs from the suggested cells");
+            if (failures > 0) break;
+            service.handle(std::string("{\"type\":\"new_piece\",\"piece\":\"") + toString(bag.getNext()) + "\"}");
+        }
+        expect(placed == PIECES, "the session stopped before every piece was placed");
+        std::printf("session: %d of %d pieces round-tripped\n", placed, PIECES);
+    }
+
+    int runSelfCheck() {
+        checkPoseTable();
+        checkSession();
+        std::printf("%s\n", failures == 0 ? "ok" : "FAILED");
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--check") == 0) return runSelfCheck();
+    unsigned threads = 0;
+    const char* pcPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--pcdb") == 0 && i + 1 < argc) pcPath = argv[++i];
+        else threads = static_cast<unsigned>(std::strtoul(argv[i], nullptr, 10));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Service service(threads);
+    service.pcDatabase.path = pcPath;
+    // TBP では起動したらまず info を送る
+    std::printf("{\"type\":\"info\",\"name\":\"CreateTetris\",\"version\":\"1.0\",\"author\":\"Kii_o\",\"features\":[]}\n");
+    std::fflush(stdout);
+
+    std::ios::sync_with_stdio(false);
+    std::string line;
+    while (std::getline(std::cin, line))
+        if (!service.handle(line)) break;
+    service.finish();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "answered %llu messages in %.3f s\n", static_cast<unsigned long long>(service.answered()), seconds);
+    return 0;
+}
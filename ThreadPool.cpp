@@ -0,0 +1,109 @@
+#include "ThreadPool.hpp"
+
+namespace {
+    // 今のスレッドがどのプールの何番目のワーカーか
+    thread_local const ThreadPool* tlsPool = nullptr;
+    thread_local int tlsIndex = -1;
+}
+
+// コンストラクタ：ワーカースレッドを起動
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1; // コア数が取得できない環境用
+
+    for (unsigned i = 0; i < threadCount; ++i) workers.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < threadCount; ++i) threads.emplace_back([this, i] { workerLoop(static_cast<int>(i)); });
+}
+
+// デストラクタ：残っているタスクを終わらせてからスレッドを止める
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeCond.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+int ThreadPool::currentWorker() const {
+    return tlsPool == this ? tlsIndex : -1;
+}
+
+// タスクを追加（ワーカーからなら自分のキュー、外からなら順番に振り分け）
+void ThreadPool::submit(Task task) {
+    int index = currentWorker();
+    if (index < 0) index = static_cast<int>(nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size());
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mtx);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    // queued と idle は seq_cst で読み書きし、ワーカーが眠る直前の判定と食い違わないようにする
+    queued.fetch_add(1);
+
+    // 眠っているワーカーがいるときだけ起こす（sleepMutex を通すことで起こし損ねを防ぐ）
+    if (idle.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wakeCond.notify_one();
+    }
+}
+
+// すべてのタスクが終わるまで待つ
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    doneCond.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+// 自分のキューの末尾から取り出す
+bool ThreadPool::popLocal(int index, Task& out) {
+    Worker& w = *workers[index];
+    std::lock_guard<std::mutex> lock(w.mtx);
+    if (w.tasks.empty()) return false;
+    out = std::move(w.tasks.back());
+    w.tasks.pop_back();
+    return true;
+}
+
+// 他のワーカーのキューの先頭から盗む
+bool ThreadPool::steal(int index, Task& out) {
+    int n = static_cast<int>(workers.size());
+    for (int k = 1; k < n; ++k) {
+        Worker& w = *workers[(index + k) % n];
+        std::unique_lock<std::mutex> lock(w.mtx, std::try_to_lock);
+        if (!lock.owns_lock() || w.tasks.empty()) continue;
+        out = std::move(w.tasks.front());
+        w.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+// ワーカーのメインループ
+void ThreadPool::workerLoop(int index) {
+    tlsPool = this;
+    tlsIndex = index;
+
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            // 最後のタスクが終わったら wait() している側を起こす
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                { std::lock_guard<std::mutex> lock(sleepMutex); }
+                doneCond.notify_all();
+            }
+            continue;
+        }
+
+        // 仕事がなければ、タスクが積まれるまで眠る
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping) return;
+        idle.fetch_add(1);
+        wakeCond.wait(lock, [this] { return stopping || queued.load() > 0; });
+        idle.fetch_sub(1);
+        if (stopping && queued.load() == 0) return;
+    }
+}
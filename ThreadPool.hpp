@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==== ワークスティーリング方式のスレッドプール ====
+// ワーカーごとに自分専用のタスクキュー(deque)を持つ
+// ・自分のキューは末尾から取り出す（直前に積んだタスク＝キャッシュに乗っている可能性が高い）
+// ・自分のキューが空になったら、他のワーカーのキューの先頭から盗む（大きめのタスクが残っている）
+// ワーカーの中から submit したタスクは、そのワーカー自身のキューに積まれる
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(unsigned threadCount = 0); // 0ならCPUのコア数だけワーカーを作る
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task task);                        // タスクを追加する
+    void wait();                                   // 積まれたタスクがすべて終わるまで待つ（ワーカーの外から呼ぶこと）
+
+    unsigned size() const { return static_cast<unsigned>(threads.size()); }
+    // 仕事を探して眠っているワーカーがいるか（タスクを分割するかどうかの目安）
+    bool hasIdleWorker() const { return idle.load(std::memory_order_relaxed) > 0; }
+    // 今のスレッドがこのプールのワーカーなら、その番号を返す（それ以外は -1）
+    int currentWorker() const;
+
+private:
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::atomic<int> pending{ 0 };                 // 未完了のタスク数（実行中を含む）
+    std::atomic<int> queued{ 0 };                  // キューに積まれていて、まだ誰も取っていないタスク数
+    std::atomic<int> idle{ 0 };                    // 眠っているワーカー数
+    std::atomic<unsigned> nextWorker{ 0 };         // 外部から submit したときの振り分け先
+    bool stopping = false;                         // sleepMutex で保護
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeCond;              // タスクが積まれたらワーカーを起こす
+    std::condition_variable doneCond;              // pending が0になったら wait() を起こす
+
+    bool popLocal(int index, Task& out);
+    bool steal(int index, Task& out);
+    void workerLoop(int index);
+};
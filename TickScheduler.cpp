@@ -0,0 +1,67 @@
+#include "TickScheduler.hpp"
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace {
+    // OSのスリープは目標の時刻より遅れて起きることがあるので、この分だけ早めに起きて、残りは yield しながら待つ
+    // Windows はタイマーの分解能が1ms（timeBeginPeriod(1) を使った場合）なので余裕を多めに取る
+#ifdef _WIN32
+    const std::chrono::microseconds WAKE_MARGIN(1500);
+#else
+    const std::chrono::microseconds WAKE_MARGIN(200);
+#endif
+}
+
+// ==================== TickScheduler クラス ====================
+TickScheduler::TickScheduler(int ticksPerSecond)
+    : tickInterval(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / ticksPerSecond))) {
+#ifdef _WIN32
+    // 標準のタイマー分解能（約15.6ms）ではスリープが粗すぎるので、1msにする
+    timeBeginPeriod(1);
+#endif
+    restart();
+}
+
+TickScheduler::~TickScheduler() {
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void TickScheduler::restart() {
+    nextTick = Clock::now() + tickInterval;
+}
+
+// 予定の時刻を過ぎたティックの数を返し、次の予定の時刻を進める
+int TickScheduler::ticksDue() {
+    Clock::time_point now = Clock::now();
+    int due = 0;
+    while (now >= nextTick && due < MAX_CATCH_UP) {
+        nextTick += tickInterval;
+        ++due;
+    }
+    // それでも遅れている（ウィンドウを動かしていた・スリープから復帰したなど）なら、遅れは取り戻さずに今から数え直す
+    if (now >= nextTick) nextTick = now + tickInterval;
+    return due;
+}
+
+void TickScheduler::waitForNextTick() const {
+    Clock::time_point wake = nextTick - WAKE_MARGIN;
+    if (Clock::now() < wake) std::this_thread::sleep_until(wake);
+    while (Clock::now() < nextTick) std::this_thread::yield();
+}
+
+// 次のティックが maxWait より先なら、maxWait だけ眠って戻る（この場合は時刻の正確さはいらないので yield はしない）
+void TickScheduler::waitForNextTick(Clock::duration maxWait) const {
+    Clock::time_point limit = Clock::now() + maxWait;
+    if (limit < nextTick - WAKE_MARGIN) {
+        std::this_thread::sleep_until(limit);
+        return;
+    }
+    waitForNextTick();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+
+// ==== 一定間隔でティックを進めるためのタイマー ====
+// ゲームの更新（ティック）は決まった間隔で行い、描画の速さとは切り離す
+// ・ticksDue() で「今までに進めるべきティック数」を受け取って、その回数だけ Simulation::tick を呼ぶ
+// ・waitForNextTick() で次のティックの時刻まで眠る（CPUを回し続けない）
+// SFMLには依存しない
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // 1回の ticksDue で返す最大数（処理が間に合わなかったときに、まとめて大量に進めないようにする）
+    static const int MAX_CATCH_UP = 5;
+
+    explicit TickScheduler(int ticksPerSecond);
+    ~TickScheduler();
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler& operator=(const TickScheduler&) = delete;
+
+    void restart();                          // 今の時刻から数え直す
+    int ticksDue();                          // 前回から今までに進めるべきティック数（0～MAX_CATCH_UP）
+    void waitForNextTick() const;            // 次のティックの時刻まで眠る
+    void waitForNextTick(Clock::duration maxWait) const; // 同じく、ただし最大 maxWait で起きる（入力を見に行くため）
+    Clock::duration interval() const { return tickInterval; }
+
+private:
+    Clock::duration tickInterval;
+    Clock::time_point nextTick;              // 次のティックを進める時刻
+};
@@ -0,0 +1,143 @@
+#include "Trace.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trace {
+    namespace {
+        const EventInfo EVENT_INFO[] = {
+            { "rotate.before", { "type", "rotation", "x", "y" } },
+            { "rotate.after",  { "type", "rotation", "x", "y" } },
+            { "hold",          { "held", "current", nullptr, nullptr } },
+        };
+        static_assert(sizeof(EVENT_INFO) / sizeof(EVENT_INFO[0]) == static_cast<int>(Event::Count),
+                      "every trace event needs a name");
+
+        // ---- スレッドごとのリングバッファ ----
+        // 書くのはそのスレッドだけ、読むのは書き出しスレッドだけなので、ロックはいらない
+        // （head と tail は書いた数・読んだ数で、増え続ける。位置は BUFFER_SIZE で割った余り）
+        const std::uint64_t BUFFER_SIZE = 4096;  // 2のべき乗
+        struct Buffer {
+            std::array<Record, BUFFER_SIZE> records;
+            std::atomic<std::uint64_t> head{ 0 };
+            std::atomic<std::uint64_t> tail{ 0 };
+            std::uint8_t thread = 0;
+        };
+
+        // 全スレッドのバッファ（スレッドが終わっても残りを書き出せるように、プログラムの終わりまで消さない）
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<Buffer>> buffers;
+        thread_local Buffer* localBuffer = nullptr;
+
+        std::atomic<bool> enabled{ false };
+        std::atomic<std::uint64_t> dropped{ 0 };
+        std::chrono::steady_clock::time_point epoch;
+
+        // ---- 書き出しスレッド ----
+        const std::chrono::milliseconds FLUSH_INTERVAL(10);
+        std::thread flusher;
+        std::mutex flushMutex;
+        std::condition_variable flushWake;
+        bool stopping = false;
+        std::FILE* output = nullptr;
+
+        Buffer& bufferOfThisThread() {
+            if (!localBuffer) {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                buffers.push_back(std::make_unique<Buffer>());
+                localBuffer = buffers.back().get();
+                localBuffer->thread = static_cast<std::uint8_t>(buffers.size() - 1);
+            }
+            return *localBuffer;
+        }
+
+        // たまっている記録をすべてファイルに書く（書き出しスレッドと stop からだけ呼ぶ）
+        void drainAll() {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (auto& buffer : buffers) {
+                std::uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+                std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+                while (tail != head) {
+                    // リングの終わりをまたぐときは2回に分けて書く
+                    std::uint64_t index = tail % BUFFER_SIZE;
+                    std::uint64_t n = std::min(head - tail, BUFFER_SIZE - index);
+                    std::fwrite(&buffer->records[index], sizeof(Record), static_cast<std::size_t>(n), output);
+                    tail += n;
+                }
+                buffer->tail.store(tail, std::memory_order_release);
+            }
+            std::fflush(output);
+        }
+
+        void flushLoop() {
+            std::unique_lock<std::mutex> lock(flushMutex);
+            while (!stopping) {
+                flushWake.wait_for(lock, FLUSH_INTERVAL);
+                drainAll();
+            }
+        }
+    }
+
+    const EventInfo& infoOf(Event event) {
+        return EVENT_INFO[static_cast<int>(event)];
+    }
+
+    bool start(const char* path) {
+        if (output) return false;
+        output = std::fopen(path, "wb");
+        if (!output) return false;
+        std::fwrite(FILE_MAGIC, 1, sizeof(FILE_MAGIC), output);
+
+        epoch = std::chrono::steady_clock::now();
+        stopping = false;
+        enabled.store(true, std::memory_order_release);
+        flusher = std::thread(flushLoop);
+        return true;
+    }
+
+    void stop() {
+        if (!output) return;
+        enabled.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(flushMutex);
+            stopping = true;
+        }
+        flushWake.notify_one();
+        flusher.join();
+        drainAll();
+        std::fclose(output);
+        output = nullptr;
+    }
+
+    std::uint64_t droppedCount() {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    // 呼んだスレッドのバッファに1件書く（いっぱいなら捨てる。待つことはない）
+    void write(int level, Event event, const std::int32_t (&args)[4]) {
+        if (!enabled.load(std::memory_order_acquire)) return;
+        Buffer& buffer = bufferOfThisThread();
+        std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        if (head - buffer.tail.load(std::memory_order_acquire) >= BUFFER_SIZE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Record& r = buffer.records[head % BUFFER_SIZE];
+        r.time = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+        r.event = static_cast<std::uint16_t>(event);
+        r.level = static_cast<std::uint8_t>(level);
+        r.thread = buffer.thread;
+        for (int i = 0; i < 4; ++i) r.args[i] = args[i];
+        r.reserved = 0;
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+
+// ==== トレース（デバッグ用の記録） ====
+// std::cout に直接書くと、出力のたびに端末への書き込みを待つことになり、ゲームの処理が止まってしまう
+// そこで、記録は「スレッドごとのリングバッファに32バイトの固定長レコードを書くだけ」にして、
+// ファイルへの書き出しは別スレッド（trace::start で開始）がまとめて行う
+// ・書き出したファイルはバイナリなので、TraceDump.cpp のプログラムで文字に戻して読む
+// ・記録するレベルはコンパイル時に決める。無効なレベルの TRACE_xxx は何も生成しない（引数も評価されない）
+// ・バッファがいっぱいのときは待たずに捨てる（捨てた数は記録される）
+
+// ---- 記録するレベル（TRACE_LEVEL 以下のものだけ記録する） ----
+#define TRACE_LEVEL_OFF   0
+#define TRACE_LEVEL_INFO  1
+#define TRACE_LEVEL_DEBUG 2
+
+// コンパイラの設定で -DTRACE_LEVEL=0 などと指定できる
+// 指定がなければ、Debug ビルドはすべて、Release ビルド（NDEBUG）は INFO まで
+#ifndef TRACE_LEVEL
+#ifdef NDEBUG
+#define TRACE_LEVEL TRACE_LEVEL_INFO
+#else
+#define TRACE_LEVEL TRACE_LEVEL_DEBUG
+#endif
+#endif
+
+namespace trace {
+    // 記録するできごとの種類（ファイルにはこの番号で書く。番号を変えると古いファイルが読めなくなるので、追加は末尾に）
+    enum class Event : std::uint16_t {
+        RotateBefore,   // 回転前        (種類, 回転状態, x, y)
+        RotateAfter,    // 回転後        (種類, 回転状態, x, y)
+        Hold,           // ホールド      (ホールドしたピース, 出てきたピース)
+        Count
+    };
+
+    // できごとの名前と、引数の名前（TraceDump で表示に使う）
+    struct EventInfo {
+        const char* name;
+        const char* args[4];
+    };
+    const EventInfo& infoOf(Event event);
+
+    // ファイルに書く1件分の記録（32バイト）
+    struct Record {
+        std::uint64_t time;         // trace::start してからのナノ秒
+        std::uint16_t event;        // Event の番号
+        std::uint8_t level;         // TRACE_LEVEL_xxx
+        std::uint8_t thread;        // 記録したスレッドの番号（最初に記録した順に 0, 1, 2, ...）
+        std::int32_t args[4];
+        std::uint32_t reserved;
+    };
+    static_assert(sizeof(Record) == 32, "trace record must stay 32 bytes");
+
+    // ファイルの先頭に書く目印
+    const char FILE_MAGIC[4] = { 'T', 'R', 'C', '1' };
+
+    // 書き出しスレッドを開始する（path にバイナリで書く。開けなければ false）
+    bool start(const char* path);
+    // 残りを書き出してスレッドを止める
+    void stop();
+    // バッファがいっぱいで捨てた記録の数
+    std::uint64_t droppedCount();
+
+    // 記録する（直接呼ばずに TRACE_INFO / TRACE_DEBUG を使う）
+    void write(int level, Event event, const std::int32_t (&args)[4]);
+
+    // 引数（最大4つ。足りない分は 0）を整数にそろえて write に渡す
+    template <class... Args>
+    inline void record(int level, Event event, Args... args) {
+        static_assert(sizeof...(Args) <= 4, "trace records hold at most 4 arguments");
+        const std::int32_t values[4] = { static_cast<std::int32_t>(args)... };
+        write(level, event, values);
+    }
+}
+
+// ---- 記録する場所に書くマクロ ----
+// 例：TRACE_DEBUG(trace::Event::RotateBefore, type, rotation, x, y);
+#if TRACE_LEVEL >= TRACE_LEVEL_INFO
+#define TRACE_INFO(...) trace::record(TRACE_LEVEL_INFO, __VA_ARGS__)
+#else
+#define TRACE_INFO(...) ((void)0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(...) trace::record(TRACE_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define TRACE_DEBUG(...) ((void)0)
+#endif
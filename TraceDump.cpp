@@ -0,0 +1,47 @@
+// ==== トレースのファイルを文字に戻して表示するプログラム ====
+// trace::start で書き出したバイナリのファイルを読み、1件1行で表示する
+// SFMLには依存しない
+//
+// 使い方: TraceDump <トレースのファイル>
+//   表示の例: 12.345678 ms  thread 0  DEBUG  rotate.before  type=0 rotation=0 x=3 y=0
+#include "Trace.hpp"
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: TraceDump <trace file>\n");
+        return 1;
+    }
+    std::FILE* file = std::fopen(argv[1], "rb");
+    if (!file) {
+        std::fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    char magic[sizeof(trace::FILE_MAGIC)];
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        std::memcmp(magic, trace::FILE_MAGIC, sizeof(magic)) != 0) {
+        std::fprintf(stderr, "%s is not a trace file\n", argv[1]);
+        std::fclose(file);
+        return 1;
+    }
+
+    trace::Record r;
+    long long count = 0;
+    while (std::fread(&r, sizeof(r), 1, file) == 1) {
+        ++count;
+        std::printf("%12.6f ms  thread %u  %-5s  ", r.time / 1e6, r.thread, r.level == TRACE_LEVEL_INFO ? "INFO" : "DEBUG");
+        if (r.event >= static_cast<int>(trace::Event::Count)) {
+            std::printf("unknown(%u)  %d %d %d %d\n", r.event, r.args[0], r.args[1], r.args[2], r.args[3]);
+            continue;
+        }
+        const trace::EventInfo& info = trace::infoOf(static_cast<trace::Event>(r.event));
+        std::printf("%-14s", info.name);
+        for (int i = 0; i < 4 && info.args[i]; ++i) std::printf(" %s=%d", info.args[i], r.args[i]);
+        std::printf("\n");
+    }
+    std::fclose(file);
+    std::fprintf(stderr, "%lld records\n", count);
+    return 0;
+}
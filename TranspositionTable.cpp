@@ -0,0 +1,125 @@
+#include "TranspositionTable.hpp"
+
+// データの詰め方：value(32bit) | depth(16bit) | flags(8bit) | 世代(8bit)
+// 世代は1以上なので、使用中のスロットのデータが0になることはない
+std::uint64_t TranspositionTable::pack(const TTEntry& e, std::uint8_t gen) {
+    return static_cast<std::uint64_t>(e.value)
+         | (static_cast<std::uint64_t>(e.depth) << 32)
+         | (static_cast<std::uint64_t>(e.flags) << 48)
+         | (static_cast<std::uint64_t>(gen) << 56);
+}
+
+TTEntry TranspositionTable::unpack(std::uint64_t data) {
+    TTEntry e;
+    e.value = static_cast<std::uint32_t>(data);
+    e.depth = static_cast<std::uint16_t>(data >> 32);
+    e.flags = static_cast<std::uint8_t>(data >> 48);
+    return e;
+}
+
+TranspositionTable::TranspositionTable(std::size_t megabytes, ReplacePolicy policy) : policy(policy) {
+    resize(megabytes);
+}
+
+// 指定したメモリ量に収まる最大の2の累乗個のバケットを確保する
+void TranspositionTable::resize(std::size_t megabytes) {
+    std::size_t bytes = megabytes * 1024 * 1024;
+    std::size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= bytes) count *= 2;
+    table.reset(new Bucket[count]);
+    buckets = count;
+    clear();
+}
+
+void TranspositionTable::clearSlots() {
+    for (std::size_t i = 0; i < buckets; ++i)
+        for (auto& s : table[i].slots) {
+            s.check.store(0, std::memory_order_relaxed);
+            s.data.store(0, std::memory_order_relaxed);
+        }
+}
+
+void TranspositionTable::clear() {
+    clearSlots();
+    for (auto& c : counters) {
+        c.hits = 0;
+        c.misses = 0;
+        c.stores = 0;
+        c.replacements = 0;
+    }
+    generation = 1;
+}
+
+void TranspositionTable::newSearch() {
+    std::uint8_t next = static_cast<std::uint8_t>(generation.load() + 1);
+    if (next == 0) {
+        // 0 は空きスロットを表すので使わない。1 に戻る前に、255 回前までの結果を消しておく
+        clearSlots();
+        next = 1;
+    }
+    generation = next;
+}
+
+// 表を引く（前の探索の世代の結果は、別の問題の結果かもしれないので使わない）
+bool TranspositionTable::probe(std::uint64_t key, TTEntry& out) {
+    Bucket& b = table[key & (buckets - 1)];
+    std::uint8_t gen = generation.load(std::memory_order_relaxed);
+    for (auto& s : b.slots) {
+        std::uint64_t data = s.data.load(std::memory_order_relaxed);
+        if (data != 0 && static_cast<std::uint8_t>(data >> 56) == gen && (s.check.load(std::memory_order_relaxed) ^ data) == key) {
+            out = unpack(data);
+            shard(key).hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    shard(key).misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// 表に書き込む（置き換え先は policy に従って選ぶ）
+void TranspositionTable::store(std::uint64_t key, const TTEntry& entry) {
+    Bucket& b = table[key & (buckets - 1)];
+    std::uint8_t gen = generation.load(std::memory_order_relaxed);
+
+    Slot* target = nullptr;
+    bool replacing = false;
+    int worstScore = 0;
+    for (auto& s : b.slots) {
+        std::uint64_t data = s.data.load(std::memory_order_relaxed);
+        // 同じ局面か空きスロットがあればそこに書く
+        if (data == 0 || (s.check.load(std::memory_order_relaxed) ^ data) == key) {
+            target = &s;
+            replacing = false;
+            break;
+        }
+        // 追い出す候補の評価（小さいほど追い出しやすい。Always のときは下でキーから選ぶので見ない）
+        bool stale = static_cast<std::uint8_t>(data >> 56) != gen;
+        int score = static_cast<int>(static_cast<std::uint16_t>(data >> 32)) + (stale ? 0 : 0x10000);
+        if (target == nullptr || score < worstScore) {
+            target = &s;
+            worstScore = score;
+            replacing = true;
+        }
+    }
+    // Always：追い出す先はキーの上位ビットで決める（バケットの4スロットに散らばり、同じ局面はいつも同じスロットに入る）
+    if (replacing && policy == ReplacePolicy::Always) target = &b.slots[(key >> 56) & (SLOTS - 1)];
+
+    std::uint64_t data = pack(entry, gen);
+    target->check.store(key ^ data, std::memory_order_relaxed);
+    target->data.store(data, std::memory_order_relaxed);
+
+    Counters& c = shard(key);
+    c.stores.fetch_add(1, std::memory_order_relaxed);
+    if (replacing) c.replacements.fetch_add(1, std::memory_order_relaxed);
+}
+
+TTStats TranspositionTable::stats() const {
+    TTStats s;
+    for (const auto& c : counters) {
+        s.hits += c.hits.load(std::memory_order_relaxed);
+        s.misses += c.misses.load(std::memory_order_relaxed);
+        s.stores += c.stores.load(std::memory_order_relaxed);
+        s.replacements += c.replacements.load(std::memory_order_relaxed);
+    }
+    return s;
+}
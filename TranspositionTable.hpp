@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// ==== 探索スレッドで共有する置換表（トランスポジションテーブル） ====
+// 局面のハッシュをキーに、探索結果を固定サイズの表に覚えておく
+// ・ロックを使わない：各スロットは (キー ^ データ, データ) の2つの64bit値で保存し、
+//   読むときに XOR し直してキーが一致するかを確かめる。
+//   別スレッドの書き込みと混ざって壊れたスロットはキーが一致しなくなるので、単に「見つからない」扱いになる
+// ・1バケット = 4スロット = 64バイト（キャッシュライン1本）で、同じバケット内で置き換え先を選ぶ
+
+// 表に保存する内容
+struct TTEntry {
+    std::uint32_t value = 0;        // 探索結果（使い方は探索側が決める）
+    std::uint16_t depth = 0;        // その結果を得るのに調べた深さ（大きいほど価値が高い）
+    std::uint8_t flags = 0;         // 探索側が自由に使うフラグ
+};
+
+// 置き換え方針
+enum class ReplacePolicy {
+    Always,         // 常に新しい結果で上書きする（同じキーも空きもなければ、キーの上位ビットで選んだスロットを追い出す）
+    DepthPreferred  // 古い世代のもの → 深さの浅いもの の順に追い出す
+};
+
+// 統計情報
+struct TTStats {
+    std::uint64_t hits = 0;         // probe で見つかった回数
+    std::uint64_t misses = 0;       // probe で見つからなかった回数
+    std::uint64_t stores = 0;       // store した回数
+    std::uint64_t replacements = 0; // 別の局面を追い出して書き込んだ回数
+};
+
+class TranspositionTable {
+public:
+    // megabytes：表に使うメモリ量（マシンのメモリに合わせて指定する）
+    explicit TranspositionTable(std::size_t megabytes = 64, ReplacePolicy policy = ReplacePolicy::DepthPreferred);
+
+    void resize(std::size_t megabytes);             // 表の大きさを変える（中身は消える。探索中に呼ばないこと）
+    void clear();                                   // 中身と統計を消す
+    // 世代を進める。前の世代の結果は probe で見つからなくなり、優先して追い出される
+    // （世代が一周したら、古い結果が同じ世代に見えないように中身を消す）
+    void newSearch();
+
+    bool probe(std::uint64_t key, TTEntry& out);    // 今の世代で書いたものが見つかれば out に入れて true
+    void store(std::uint64_t key, const TTEntry& entry);
+
+    TTStats stats() const;
+    std::size_t bucketCount() const { return buckets; }
+    std::size_t memoryBytes() const { return buckets * sizeof(Bucket); }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check{ 0 };      // キー ^ データ
+        std::atomic<std::uint64_t> data{ 0 };       // 詰めた TTEntry（0 は空きスロット）
+    };
+    static const int SLOTS = 4;
+    struct alignas(64) Bucket {
+        Slot slots[SLOTS];
+    };
+
+    // 統計カウンタは複数に分けて、同じキャッシュラインの奪い合いを減らす
+    static const int SHARDS = 16;
+    struct alignas(64) Counters {
+        std::atomic<std::uint64_t> hits{ 0 }, misses{ 0 }, stores{ 0 }, replacements{ 0 };
+    };
+
+    std::unique_ptr<Bucket[]> table;
+    std::size_t buckets = 0;                         // 2の累乗
+    ReplacePolicy policy;
+    std::atomic<std::uint8_t> generation{ 1 };
+    Counters counters[SHARDS];
+
+    static std::uint64_t pack(const TTEntry& e, std::uint8_t gen);
+    static TTEntry unpack(std::uint64_t data);
+    void clearSlots();
+    Counters& shard(std::uint64_t key) { return counters[key >> 60]; }
+};
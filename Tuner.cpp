@@ -0,0 +1,323 @@
+// ==== 評価の重み（EvalWeights）を自己対戦で調整するプログラム ====
+// Bot（BeamBot）にウィンドウなしでゲームを遊ばせ、成績の良い重みに近づけていく（進化戦略）
+// ・1世代ごとに、今の重み（平均）のまわりに正規分布で候補を作り、候補ごとに同じシードのゲームを遊ばせる
+// ・成績の良い半分の候補の重み付き平均を次の平均にし、その散らばりから次の世代の幅（sigma）を決める
+// ・ゲームは全部のコアで分担して遊ぶ（次に遊ぶゲームの番号を atomic で取り合う）
+// ・世代が終わるたびにチェックポイントを書くので、途中で止めても同じファイルを指定すれば続きから再開できる
+//   （候補もゲームのシードも、シードと世代番号から決まるので、再開しても止めなかったときと同じ結果になる）
+// ゲーム中はせり上がり（おじゃまライン）が少しずつ増えていき、攻撃（attackOf）で打ち消さないと押し上げられる
+// せり上がりの量は、最後には1ピースあたり消せるライン数の上限（0.4）を超えるので、どの重みでもいずれは負ける
+// （せり上がりがないと、どの候補もほぼ全部のピースを置き切ってしまい、生き残りの差がつかない）
+// 成績 = 生き残ったピース数（PIECE_LIMIT に対する割合）+ 1ピースあたりの攻撃 + PC_WEIGHT × パフェの割合
+//
+// 使い方:
+//   Tuner <チェックポイント> [世代数] [候補1つあたりのゲーム数] [スレッド数] [シード]
+//       … チェックポイントがあればその続きから、なければ EvalWeights の初期値から始める
+//         候補1つあたりのゲーム数で成績の値が変わるので、チェックポイントに書いておき、再開するときはその値を使う
+//         （違う値を指定したら再開しない）
+#include "Bot.hpp"
+#include "Simulation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const int POPULATION = 16;               // 1世代の候補の数
+    const int PARENTS = POPULATION / 2;      // 次の平均を作るのに使う上位の候補の数
+    const int PIECE_LIMIT = 500;             // 1ゲームで置くピースの上限（ここまで生き残れば終わり）
+    // 1ピースあたりのせり上がりの量（ライン）。最初は GARBAGE_START で、PIECE_LIMIT 個目で GARBAGE_END になるよう増やす
+    const float GARBAGE_START = 0.1f;
+    const float GARBAGE_END = 0.6f;
+    const int BEAM_WIDTH = 8;                // 自己対戦の Bot の幅と深さ（毎回同じ手を選ぶように固定する）
+    const int BEAM_DEPTH = 2;
+    const float PC_WEIGHT = 10.f;            // パフェの割合にかける重み
+    const float MIN_SIGMA = 0.005f;
+    const int CHECKPOINT_VERSION = 2;        // 2: せり上がりを入れた成績、候補1つあたりのゲーム数を記録
+
+    // 調整する重み（EvalWeights のメンバーを並べたもの）
+    const int DIMENSIONS = 7;
+    using Genome = std::array<float, DIMENSIONS>;
+    const char* const NAMES[DIMENSIONS] = {
+        "aggregateHeight", "maxHeight", "holes", "bumpiness", "wellDepth", "rowTransitions", "lines"
+    };
+
+    Genome toGenome(const EvalWeights& w) {
+        return { w.aggregateHeight, w.maxHeight, w.holes, w.bumpiness, w.wellDepth, w.rowTransitions, w.lines };
+    }
+
+    EvalWeights toWeights(const Genome& g) {
+        EvalWeights w;
+        w.aggregateHeight = g[0];
+        w.maxHeight = g[1];
+        w.holes = g[2];
+        w.bumpiness = g[3];
+        w.wellDepth = g[4];
+        w.rowTransitions = g[5];
+        w.lines = g[6];
+        return w;
+    }
+
+    // 1ゲーム（または候補1つ分のゲームの合計）の成績
+    struct GameResult {
+        long long pieces = 0;
+        long long lines = 0;
+        long long attack = 0;
+        long long perfectClears = 0;
+    };
+
+    float fitnessOf(const GameResult& r, int games) {
+        if (r.pieces == 0) return 0.f;
+        float survival = static_cast<float>(r.pieces) / (games * PIECE_LIMIT);
+        float attackPerPiece = static_cast<float>(r.attack) / r.pieces;
+        float pcRate = static_cast<float>(r.perfectClears) / r.pieces;
+        return survival + attackPerPiece + PC_WEIGHT * pcRate;
+    }
+
+    // シード seed のゲームを重み w で遊ぶ
+    // 1ピース置くたびにせり上がりがたまり、攻撃で打ち消した残りが1ライン以上になったら下から押し上げる
+    // （穴の列もシードから決めるので、同じシードなら候補が違っても同じせり上がりになる）
+    GameResult playGame(BeamBot& bot, Simulation& sim, const EvalWeights& w, std::uint32_t seed) {
+        bot.weights = w;
+        bot.resetStats();
+        sim.reset(seed);
+        std::mt19937 holes(seed);
+        float pending = 0.f;
+        GameResult r;
+        while (r.pieces < PIECE_LIMIT && !sim.isGameOver()) {
+            if (!bot.play(sim)) break;
+            const LockResult& lock = sim.lastLock();
+            ++r.pieces;
+            r.lines += lock.linesCleared;
+            r.attack += attackOf(lock);
+            if (lock.perfectClear) ++r.perfectClears;
+
+            float progress = static_cast<float>(r.pieces) / PIECE_LIMIT;
+            pending += GARBAGE_START + (GARBAGE_END - GARBAGE_START) * progress;
+            pending = std::max(0.f, pending - attackOf(lock));
+            int lines = static_cast<int>(pending);
+            if (lines > 0) {
+                pending -= lines;
+                sim.addGarbage(lines, static_cast<int>(holes() % Board::WIDTH));
+            }
+        }
+        return r;
+    }
+
+    // ==== 調整の状態（チェックポイントに書く内容） ====
+    struct TunerState {
+        std::uint32_t seed = 1;
+        int generation = 0;                  // 終わった世代の数
+        Genome mean = toGenome(EvalWeights());
+        Genome sigma;
+        float bestFitness = -1.f;            // これまでで一番良かった候補
+        Genome best = toGenome(EvalWeights());
+        long long gamesPlayed = 0;
+        int gamesPerCandidate = 32;          // 成績を比べられるのは、この値が同じもの同士だけ
+
+        TunerState() { sigma.fill(0.1f); }
+    };
+
+    // 1行に「名前 値...」の形で書く（人が読んでも分かるように）
+    bool saveCheckpoint(const std::string& path, const TunerState& s) {
+        // 書いている途中で止まっても前のチェックポイントが壊れないように、別のファイルに書いてから置き換える
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp);
+            if (!out) return false;
+            out << "tuner-checkpoint " << CHECKPOINT_VERSION << "\n";
+            out << "seed " << s.seed << "\n";
+            out << "generation " << s.generation << "\n";
+            out << "games " << s.gamesPlayed << "\n";
+            out << "games-per-candidate " << s.gamesPerCandidate << "\n";
+            out.precision(9);
+            out << "mean";
+            for (float v : s.mean) out << ' ' << v;
+            out << "\nsigma";
+            for (float v : s.sigma) out << ' ' << v;
+            out << "\nbest " << s.bestFitness;
+            for (float v : s.best) out << ' ' << v;
+            out << "\n";
+            if (!out) return false;
+        }
+        std::remove(path.c_str()); // Windows の rename は上書きできない
+        return std::rename(temp.c_str(), path.c_str()) == 0;
+    }
+
+    bool loadCheckpoint(const std::string& path, TunerState& s) {
+        std::ifstream in(path);
+        if (!in) return false;
+        std::string line, key;
+        int version = 0;
+        if (!std::getline(in, line) || std::sscanf(line.c_str(), "tuner-checkpoint %d", &version) != 1 ||
+            version != CHECKPOINT_VERSION)
+            return false;
+        auto readGenome = [](std::istringstream& fields, Genome& g) {
+            for (float& v : g)
+                if (!(fields >> v)) return false;
+            return true;
+        };
+        int found = 0;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            if (!(fields >> key)) continue;
+            if (key == "seed" && fields >> s.seed) ++found;
+            else if (key == "generation" && fields >> s.generation) ++found;
+            else if (key == "games" && fields >> s.gamesPlayed) ++found;
+            else if (key == "games-per-candidate" && fields >> s.gamesPerCandidate && s.gamesPerCandidate > 0) ++found;
+            else if (key == "mean" && readGenome(fields, s.mean)) ++found;
+            else if (key == "sigma" && readGenome(fields, s.sigma)) ++found;
+            else if (key == "best" && fields >> s.bestFitness && readGenome(fields, s.best)) ++found;
+        }
+        return found == 7;
+    }
+
+    void printGenome(const char* label, const Genome& g) {
+        std::printf("%s", label);
+        for (int i = 0; i < DIMENSIONS; ++i) std::printf(" %s=%.4f", NAMES[i], g[i]);
+        std::printf("\n");
+    }
+
+    // 世代・番号から決まるシード（再開しても同じ値になる）
+    std::uint32_t mixSeed(std::uint32_t seed, int generation, int index) {
+        std::seed_seq seq{ seed, static_cast<std::uint32_t>(generation), static_cast<std::uint32_t>(index) };
+        std::uint32_t out;
+        seq.generate(&out, &out + 1);
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("usage: Tuner <checkpoint> [generations] [games per candidate] [threads] [seed]\n");
+        return 1;
+    }
+    const std::string checkpoint = argv[1];
+    int generations = argc > 2 ? std::atoi(argv[2]) : 50;
+    unsigned threads = argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 0;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    TunerState state;
+    if (loadCheckpoint(checkpoint, state)) {
+        // 候補1つあたりのゲーム数が違うと成績を比べられない（best も sigma も前の値のまま使うので）
+        if (argc > 3 && std::atoi(argv[3]) != state.gamesPerCandidate) {
+            std::fprintf(stderr, "%s was tuned with %d games per candidate; resume with the same value\n",
+                         checkpoint.c_str(), state.gamesPerCandidate);
+            return 1;
+        }
+        std::printf("resuming %s at generation %d (%lld games played, %d per candidate)\n", checkpoint.c_str(),
+                    state.generation, state.gamesPlayed, state.gamesPerCandidate);
+    }
+    else if (std::ifstream(checkpoint)) {
+        // 古い形式・壊れたファイルを最初からの調整で上書きしない
+        std::fprintf(stderr, "cannot read checkpoint %s (version %d expected)\n", checkpoint.c_str(), CHECKPOINT_VERSION);
+        return 1;
+    }
+    else {
+        if (argc > 3) state.gamesPerCandidate = std::max(1, std::atoi(argv[3]));
+        if (argc > 5) state.seed = static_cast<std::uint32_t>(std::strtoul(argv[5], nullptr, 10));
+    }
+    const int games = state.gamesPerCandidate;
+
+    const int jobs = POPULATION * games;
+    std::vector<GameResult> results(jobs);
+    std::vector<Genome> candidates(POPULATION);
+    const int lastGeneration = state.generation + generations;
+
+    for (; state.generation < lastGeneration; ++state.generation) {
+        // ---- 候補を作る（0番は今の平均そのもの） ----
+        std::mt19937 rng(mixSeed(state.seed, state.generation, -1));
+        std::normal_distribution<float> normal(0.f, 1.f);
+        candidates[0] = state.mean;
+        for (int c = 1; c < POPULATION; ++c)
+            for (int i = 0; i < DIMENSIONS; ++i) candidates[c][i] = state.mean[i] + state.sigma[i] * normal(rng);
+
+        // ---- 全部の候補に同じシードのゲームを遊ばせる（スレッドで分担） ----
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<int> nextJob{ 0 };
+        auto work = [&] {
+            BeamBot bot;
+            bot.budget = std::chrono::hours(1); // 時間では打ち切らない
+            bot.initialWidth = bot.maxWidth = BEAM_WIDTH;
+            bot.maxDepth = BEAM_DEPTH;
+            Simulation sim;
+            for (int j = nextJob.fetch_add(1); j < jobs; j = nextJob.fetch_add(1)) {
+                int c = j / games, g = j % games;
+                results[j] = playGame(bot, sim, toWeights(candidates[c]), mixSeed(state.seed, state.generation, g));
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) workers.emplace_back(work);
+        for (std::thread& w : workers) w.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // ---- 候補ごとに成績をまとめる（スレッドの実行順によらず同じ値になるよう、番号の順に足す） ----
+        std::vector<std::pair<float, int>> ranked;
+        GameResult meanResult;
+        long long pieces = 0;
+        for (int c = 0; c < POPULATION; ++c) {
+            GameResult total;
+            for (int g = 0; g < games; ++g) {
+                const GameResult& r = results[c * games + g];
+                total.pieces += r.pieces;
+                total.lines += r.lines;
+                total.attack += r.attack;
+                total.perfectClears += r.perfectClears;
+            }
+            if (c == 0) meanResult = total;
+            pieces += total.pieces;
+            ranked.emplace_back(fitnessOf(total, games), c);
+        }
+        std::stable_sort(ranked.begin(), ranked.end(),
+                         [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+        if (ranked[0].first > state.bestFitness) {
+            state.bestFitness = ranked[0].first;
+            state.best = candidates[ranked[0].second];
+        }
+
+        // ---- 上位の候補の重み付き平均を次の平均に、平均からの散らばりを次の sigma にする ----
+        std::array<float, PARENTS> rankWeights;
+        float rankTotal = 0.f;
+        for (int k = 0; k < PARENTS; ++k) rankTotal += rankWeights[k] = std::log(PARENTS + 0.5f) - std::log(k + 1.f);
+        Genome mean{}, spread{};
+        for (int k = 0; k < PARENTS; ++k) {
+            const Genome& x = candidates[ranked[k].second];
+            float w = rankWeights[k] / rankTotal;
+            for (int i = 0; i < DIMENSIONS; ++i) {
+                mean[i] += w * x[i];
+                spread[i] += w * (x[i] - state.mean[i]) * (x[i] - state.mean[i]);
+            }
+        }
+        for (int i = 0; i < DIMENSIONS; ++i)
+            state.sigma[i] = std::max(MIN_SIGMA, 0.7f * state.sigma[i] + 0.3f * std::sqrt(spread[i]));
+        state.mean = mean;
+        state.gamesPlayed += jobs;
+
+        std::printf("generation %d: best %.4f, mean %.4f (%.1f pieces/game, %.1f lines/game, %.3f attack/piece, %lld PCs), "
+                    "%.1f games/s/core, %.0f pieces/s\n",
+                    state.generation + 1, ranked[0].first, fitnessOf(meanResult, games),
+                    static_cast<double>(meanResult.pieces) / games, static_cast<double>(meanResult.lines) / games,
+                    meanResult.pieces ? static_cast<double>(meanResult.attack) / meanResult.pieces : 0.0,
+                    meanResult.perfectClears, jobs / seconds / threads, pieces / seconds);
+        std::fflush(stdout);
+
+        // 次の世代から始められるように、世代が終わった状態を書く
+        TunerState saved = state;
+        ++saved.generation;
+        if (!saveCheckpoint(checkpoint, saved)) std::fprintf(stderr, "cannot write %s\n", checkpoint.c_str());
+    }
+
+    printGenome("mean:", state.mean);
+    printGenome("best:", state.best);
+    std::printf("best fitness %.4f after %d generations, %lld games\n", state.bestFitness, state.generation,
+                state.gamesPlayed);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// ==== Zobrist ハッシュ用の乱数テーブル ====
+// 盤面の各マス・ホールド・ネクストの位置ごとに64bitの乱数を割り当て、
+// 状態に含まれるものをすべて XOR した値を局面のハッシュにする
+// （1マス置くたびに XOR 1回で更新できる）
+// 乱数はコンパイル時に splitmix64 で作るので、実行ごと・マシンごとに同じ値になる
+
+namespace zobrist {
+
+    const int ROWS = 20;            // Board::HEIGHT と同じ
+    const int HALF = 5;             // 1行10マスを5マスずつ2つに分けて表を引く
+    // ネクストの位置として区別する最大数。これより後ろのピースはハッシュに入らないので、
+    // 使う側はキーを作る前に並びを MAX_QUEUE 個までに切り、それより先を探索に使わないこと
+    // （PcSolver は最大 6段 = 15個 + ホールド1個しか使わないので足りる。Solver.cpp の static_assert を参照）
+    const int MAX_QUEUE = 64;
+
+    constexpr std::uint64_t splitmix64(std::uint64_t& state) {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // ROW_KEYS[y][h][m]：行 y の左半分(h=0)または右半分(h=1)のビット列が m のときの XOR 値
+    // 1マスずつ XOR するのと同じ値を、表を2回引くだけで求められる
+    using RowKeyTable = std::array<std::array<std::array<std::uint64_t, 1 << HALF>, 2>, ROWS>;
+
+    constexpr RowKeyTable buildRowKeys() {
+        RowKeyTable table{};
+        std::uint64_t state = 0x5EEDC0DEull;
+        for (int y = 0; y < ROWS; ++y)
+            for (int h = 0; h < 2; ++h) {
+                std::array<std::uint64_t, HALF> cell{};
+                for (int i = 0; i < HALF; ++i) cell[i] = splitmix64(state);
+                for (int m = 0; m < (1 << HALF); ++m) {
+                    std::uint64_t key = 0;
+                    for (int i = 0; i < HALF; ++i)
+                        if (m & (1 << i)) key ^= cell[i];
+                    table[y][h][m] = key;
+                }
+            }
+        return table;
+    }
+
+    template <int N>
+    constexpr std::array<std::uint64_t, N> buildKeys(std::uint64_t seed) {
+        std::array<std::uint64_t, N> keys{};
+        for (int i = 0; i < N; ++i) keys[i] = splitmix64(seed);
+        return keys;
+    }
+
+    inline constexpr RowKeyTable ROW_KEYS = buildRowKeys();
+    // HOLD_KEYS[0] はホールドなし、HOLD_KEYS[1 + (int)PieceType] がホールド中のピース
+    inline constexpr auto HOLD_KEYS = buildKeys<8>(0x40D0ull);
+    // QUEUE_KEYS[i]：次に操作するピースがネクストの i 番目であること
+    inline constexpr auto QUEUE_KEYS = buildKeys<MAX_QUEUE>(0x0E0Eull);
+    // ネクストの並びそのものを区別するための表（PIECE_KEYS[位置][種類]）
+    inline constexpr auto PIECE_KEYS = buildKeys<MAX_QUEUE * 7>(0x7777ull);
+
+    // 行 y のビット列 mask に対応する XOR 値
+    inline std::uint64_t rowKey(int y, std::uint16_t mask) {
+        return ROW_KEYS[y][0][mask & 31u] ^ ROW_KEYS[y][1][(mask >> HALF) & 31u];
+    }
+
+    // 1マス (x, y) の XOR 値
+    inline std::uint64_t cellKey(int x, int y) {
+        return rowKey(y, static_cast<std::uint16_t>(1u << x));
+    }
+}
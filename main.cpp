@@ -1,7 +1,26 @@
-#include "Piece.hpp"
+#include "Game.hpp"
+#include "Trace.hpp"
+#include <cstdlib>
+#include <cstring>
 
-int main() {
-    Game game;
+// 使い方: Tetris [--trace <ファイル>] [--bot <PPS>] [--alloc]
+// --trace を付けると、トレース（回転・ホールドなど）をファイルに書き出す（TraceDump で読める）
+// --bot を付けると、Bot が1秒に PPS 個のペースで遊ぶ（終了時に読めた深さ・判断時間の分布を表示する）
+// --alloc を付けると、終了時に、起動直後を除いてメモリを確保したフレーム・ピースの数を表示する（0 が正常）
+int main(int argc, char** argv) {
+    bool tracing = false;
+    double botPps = 0.0;
+    bool allocReport = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--alloc") == 0) allocReport = true;
+        else if (i + 1 < argc && std::strcmp(argv[i], "--trace") == 0) tracing = trace::start(argv[++i]);
+        else if (i + 1 < argc && std::strcmp(argv[i], "--bot") == 0) botPps = std::atof(argv[++i]);
+    }
+
+    Game game(botPps);
+    game.allocReport = allocReport;
     game.run();
+
+    if (tracing) trace::stop();
     return 0;
 }